@@ -3,15 +3,42 @@
 #include <string.h>
 #include <sqlite3.h>
 #include <ctype.h> // For toupper, isdigit, tolower
+#include <strings.h> // For strcasecmp
+#include <time.h>
+#include <pthread.h> // Audit journal flusher thread
+#ifdef _WIN32
+    #include <io.h>
+    #define fsync _commit
+#else
+    #include <unistd.h>
+#endif
 
 // Constants
 #define MAX_STRING 256
 #define MAX_APPOINTMENTS_PER_DAY 15
-#define DB_NAME "clinic.db"
+#define DB_NAME "clinic.db"           // Database of the single default branch
+#define BRANCH_REGISTRY "branches.cfg" // One "NAME=database file" line per clinic branch
+#define MAX_BRANCHES 32
+#define AUDIT_FLUSH_BYTES (64 * 1024)  // Group-commit once this much is buffered...
+#define AUDIT_FLUSH_INTERVAL_MS 1000   // ...or once the oldest buffered record is this old
+#define AUDIT_WAL_CHECKPOINT_PAGES 1000 // Same threshold as SQLite's default auto-checkpoint
+#define REMINDER_BUFFER_SIZE (1024 * 1024) // stdio buffer for reminder exports
+#define SCRIPT_MAX_ARGS 32
+
+#include "branch_registry.h"
+#include "../common/schema_helpers.h"
+#include "../common/specialization_cache.h"
 
 // Global database connection
 sqlite3 *db;
 
+// Branch this session works on; every branch has its own database file
+char branch_name[BRANCH_NAME_SIZE] = "MAIN";
+char branch_db_path[MAX_STRING] = DB_NAME;
+
+// Set while a command script runs, to keep per-command output quiet
+int script_mode = 0;
+
 // Utility function prototypes
 void wait_for_enter();
 void clear_screen(); // Clears the console screen
@@ -22,13 +49,35 @@ int getPositiveInt(const char *message); // Gets a positive integer input with a
 float getPositiveFloat(const char *message); // Gets a positive float input with a custom message
 char getGender(const char *message); // Gets a valid gender input (M, F, O)
 void getContactNumber(char *contact, const char *message); // Gets a valid contact number input (10 digits only)
+double monotonic_seconds(); // Wall-clock seconds for timing, unaffected by clock adjustments
 
 // DB Function Prototypes
+void select_branch(int argc, char *argv[]); // Picks the branch database from --branch NAME or the branch registry
 void connect_database();
 void initialize_database(sqlite3 *db);
+void drop_broken_appointments_table(sqlite3 *db);
+void migrate_specializations(sqlite3 *db); // Moves free-text specializations into the dictionary table
 void execute_sql(sqlite3 *db, const char *sql);
 int getRecordCount(const char *table_name, const char *id_column, int id_value);
 
+// Specialization Dictionary Prototypes (lookups: specialization_cache.h)
+int intern_specialization(const char *name);     // ID for a name, adding it to the dictionary if new
+void list_specializations();
+
+// Audit Journal Prototypes
+void audit_open(const char *path); // Starts journaling every committed row change of the connection
+void audit_close();                // Flushes and fsyncs outstanding records; registered with atexit
+
+// Command Mode Prototypes
+int run_command(int argc, char *argv[]); // Runs "app <command> ..." without the menus; returns the exit status
+const char *get_option(int argc, char *argv[], const char *name); // Value following --name, or NULL
+int get_int_option(int argc, char *argv[], const char *name); // Positive integer following --name, or 0
+int export_reminders(int argc, char *argv[]); // app reminders [--date D] [--format csv|ndjson] [--out FILE]
+int command_book(int argc, char *argv[]);
+int command_edit(int argc, char *argv[]);
+int command_cancel(int argc, char *argv[]);
+int command_run(int argc, char *argv[]);      // app run FILE [--transaction]
+
 // Menu Functions
 void show_main_menu();
 void receptionist_menu();
@@ -41,6 +90,9 @@ void add_patient();
 void view_patients();
 void edit_patient();
 void delete_patient();
+void view_patient_history();    // A patient's appointments, newest first
+const char *doctor_name(int doctor_id); // Name from the cached doctor map
+void invalidate_doctor_names();  // Call after doctors change so the map is reloaded
 
 // Doctor Management Prototypes
 void add_doc();
@@ -53,23 +105,95 @@ void schedule_appointment();
 void view_appointments();
 void edit_appointment();
 void cancel_appointment();
+int book_appointment(int patient_id, int doctor_id, const char *date, const char *time, long long *appointment_id);
+int update_appointment(int appointment_id, int doctor_id, const char *date, const char *time);
+
+// Waitlist Prototypes
+void add_to_waitlist();
+void view_waitlist();
+void remove_from_waitlist();
+int cancel_and_fill_slot(int appointment_id, int *filled_patient_id); // Deletes an appointment and books the best waiting patient into the freed slot
 
 
 // Main Function
-int main() {
-    clear_screen();
+int main(int argc, char *argv[]) {
+    int command_mode = argc > 1 && argv[1][0] != '-';
+
+    if (!command_mode) clear_screen();
+    select_branch(argc, argv);
     connect_database();
     initialize_database(db);
+    load_specializations();
+
+    char journal[MAX_STRING + 16];
+    branch_journal_path(journal, sizeof(journal), branch_db_path);
+    audit_open(journal);
+
+    if (command_mode) {
+        int status = run_command(argc - 1, argv + 1);
+        audit_close();
+        sqlite3_close(db);
+        return status;
+    }
 
     show_main_menu();
 
+    audit_close();
     sqlite3_close(db);
     return 0;
 }
 
+// Branch Selection
+//
+// Without a registry (see branch_registry.h) the program runs as the single
+// MAIN branch on clinic.db. The branch is taken from "--branch NAME" when
+// given, otherwise the receptionist picks it from the list at startup.
+void select_branch(int argc, char *argv[]) {
+    BranchEntry entries[MAX_BRANCHES];
+    int count = read_branch_registry(entries, MAX_BRANCHES);
+    if (count == 0) return; // Single-branch installation
+
+    const char *wanted = NULL;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--branch") == 0) wanted = argv[i + 1];
+    }
+
+    int chosen = -1;
+    if (wanted != NULL) {
+        for (int i = 0; i < count; i++) {
+            if (strcasecmp(entries[i].name, wanted) == 0) chosen = i;
+        }
+        if (chosen < 0) {
+            fprintf(stderr, "Unknown branch '%s' (see %s).\n", wanted, BRANCH_REGISTRY);
+            exit(1);
+        }
+    } else if (count == 1) {
+        chosen = 0;
+    } else if (argc > 1 && argv[1][0] != '-') {
+        fprintf(stderr, "Several branches are registered; pass --branch NAME.\n");
+        exit(1);
+    } else {
+        printf("=== SELECT BRANCH ===\n\n");
+        for (int i = 0; i < count; i++) {
+            printf("%d. %s\n", i + 1, entries[i].name);
+        }
+        while (chosen < 0) {
+            int choice = getPositiveInt("\nEnter your choice: ");
+            if (choice <= count) {
+                chosen = choice - 1;
+            } else {
+                printf("Invalid choice!\n");
+            }
+        }
+    }
+
+    memcpy(branch_name, entries[chosen].name, sizeof(branch_name));
+    memcpy(branch_db_path, entries[chosen].db_path, sizeof(branch_db_path));
+}
+
 // Connect Database
 void connect_database() {
-    int rc = sqlite3_open(DB_NAME, &db);
+    int rc = sqlite3_open(branch_db_path, &db);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Database error: %s\n", sqlite3_errmsg(db));
         exit(1);
@@ -104,24 +228,113 @@ void initialize_database(sqlite3 *db) {
         "gender TEXT CHECK(gender IN ('M','F','O'))"
         "); "
 
+        "CREATE TABLE IF NOT EXISTS specializations ("
+        "specialization_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "name TEXT NOT NULL UNIQUE COLLATE NOCASE"
+        "); "
+
+        // specialization keeps a copy of the dictionary name for older readers;
+        // lookups and grouping use specialization_id
         "CREATE TABLE IF NOT EXISTS doctors ("
         "doctor_id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "full_name TEXT NOT NULL, "
         "specialization TEXT NOT NULL, "
-        "contact TEXT NOT NULL"
+        "contact TEXT NOT NULL, "
+        "specialization_id INTEGER REFERENCES specializations(specialization_id)"
         "); "
 
         "CREATE TABLE IF NOT EXISTS appointments ("
         "appointment_id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "patient_id INTEGER NOT NULL, "
         "doctor_id INTEGER NOT NULL, "
-        "appointment_date TEXT NOT NULL CHECK(appointment_date GLOB '____-__-__'), "
-        "appointment_time TEXT NOT NULL CHECK(appointment_time GLOB '__:__'), "
+        "appointment_date TEXT NOT NULL CHECK(appointment_date GLOB '[0-9][0-9][0-9][0-9]-[0-9][0-9]-[0-9][0-9]'), "
+        "appointment_time TEXT NOT NULL CHECK(appointment_time GLOB '[0-9][0-9]:[0-9][0-9]'), "
+        "FOREIGN KEY(patient_id) REFERENCES patients(patient_id) ON DELETE CASCADE, "
+        "FOREIGN KEY(doctor_id) REFERENCES doctors(doctor_id) ON DELETE CASCADE"
+        "); "
+        "CREATE INDEX IF NOT EXISTS idx_appointments_date ON appointments(appointment_date); "
+        // Covers the patient history query: no table lookups per appointment
+        "CREATE INDEX IF NOT EXISTS idx_appointments_patient "
+        "ON appointments(patient_id, appointment_date, appointment_time, doctor_id); "
+
+        // Waitlist: a NULL doctor_id means "any doctor with this specialization"
+        "CREATE TABLE IF NOT EXISTS waitlist ("
+        "waitlist_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "patient_id INTEGER NOT NULL, "
+        "doctor_id INTEGER, "
+        "specialization TEXT, "
+        "specialization_id INTEGER REFERENCES specializations(specialization_id), "
+        "earliest_date TEXT NOT NULL CHECK(earliest_date GLOB '[0-9][0-9][0-9][0-9]-[0-9][0-9]-[0-9][0-9]'), "
+        "created_at TEXT NOT NULL DEFAULT (datetime('now', 'localtime')), "
+        "CHECK(doctor_id IS NOT NULL OR specialization IS NOT NULL), "
         "FOREIGN KEY(patient_id) REFERENCES patients(patient_id) ON DELETE CASCADE, "
         "FOREIGN KEY(doctor_id) REFERENCES doctors(doctor_id) ON DELETE CASCADE"
-        ");";
+        "); "
 
+        // Both indexes are ordered the way the slot matcher picks a winner,
+        // so finding the best waiting patient is a single index probe
+        "CREATE INDEX IF NOT EXISTS idx_waitlist_doctor "
+        "ON waitlist(doctor_id, earliest_date, waitlist_id);";
+
+    drop_broken_appointments_table(db);
     execute_sql(db, sql);
+    migrate_specializations(db);
+}
+
+// Doctors and waitlist entries used to carry the specialization as free text.
+// Every distinct spelling (matched case-insensitively) becomes a dictionary
+// entry and the rows are pointed at it. Rows written since already carry the
+// ID, so this is a no-op after the first run.
+void migrate_specializations(sqlite3 *db) {
+    if (!column_exists(db, "doctors", "specialization_id")) {
+        execute_sql(db, "ALTER TABLE doctors ADD COLUMN specialization_id INTEGER REFERENCES specializations(specialization_id);");
+    }
+    if (!column_exists(db, "waitlist", "specialization_id")) {
+        execute_sql(db, "ALTER TABLE waitlist ADD COLUMN specialization_id INTEGER REFERENCES specializations(specialization_id);");
+    }
+
+    run_migration(db,
+        "INSERT OR IGNORE INTO specializations (name) "
+        "SELECT TRIM(specialization) FROM doctors WHERE specialization_id IS NULL "
+        "UNION SELECT TRIM(specialization) FROM waitlist WHERE specialization_id IS NULL AND specialization IS NOT NULL; "
+        "UPDATE doctors SET specialization_id = "
+        "(SELECT specialization_id FROM specializations WHERE name = TRIM(doctors.specialization)) "
+        "WHERE specialization_id IS NULL; "
+        "UPDATE waitlist SET specialization_id = "
+        "(SELECT specialization_id FROM specializations WHERE name = TRIM(waitlist.specialization)) "
+        "WHERE specialization_id IS NULL AND specialization IS NOT NULL;");
+
+    const char *sql =
+        // Specialization waitlist entries are matched by ID, in the same
+        // order the slot matcher picks a winner
+        "DROP INDEX IF EXISTS idx_waitlist_specialization; "
+        "CREATE INDEX IF NOT EXISTS idx_waitlist_specialization_id "
+        "ON waitlist(specialization_id, earliest_date, waitlist_id) WHERE doctor_id IS NULL; "
+        "CREATE INDEX IF NOT EXISTS idx_doctors_specialization_id ON doctors(specialization_id);";
+    execute_sql(db, sql);
+}
+
+// Older builds created appointments with GLOB '____-__-__' checks, which match
+// literal underscores only, so no real appointment could ever be inserted.
+// Such a table is necessarily empty and can be recreated with the fixed checks.
+void drop_broken_appointments_table(sqlite3 *db) {
+    const char *sql = "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = 'appointments';";
+    sqlite3_stmt *stmt;
+    int broken = 0;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *ddl = (const char *)sqlite3_column_text(stmt, 0);
+        broken = ddl != NULL && strstr(ddl, "'____-__-__'") != NULL;
+    }
+    sqlite3_finalize(stmt);
+
+    if (broken && getRecordCount("appointments", "1", 1) == 0) {
+        execute_sql(db, "DROP TABLE appointments;");
+    }
 }
 
 // getRecordCount function
@@ -144,6 +357,246 @@ int getRecordCount(const char *table_name, const char *id_column, int id_value)
     return count;
 }
 
+// Specialization Dictionary
+//
+// The lookup cache itself lives in specialization_cache.h, shared with the
+// hospital appointment program. The receptionist also adds new entries.
+
+// ID of the specialization, adding it to the dictionary if it is new.
+// Returns -1 on error.
+int intern_specialization(const char *name) {
+    int id = find_specialization(name);
+    if (id > 0) return id;
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "INSERT INTO specializations (name) VALUES (?);", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "Error adding specialization: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+    sqlite3_finalize(stmt);
+    return cache_specialization((int)sqlite3_last_insert_rowid(db), name);
+}
+
+// Prints the known specializations so new entries reuse an existing spelling
+void list_specializations() {
+    if (specializations.count == 0) return;
+    printf("Known specializations:");
+    for (int i = 0; i < specializations.count; i++) {
+        printf("%s %s", i ? "," : "", specializations.entries[i].name);
+    }
+    printf("\n");
+}
+
+// Audit Journal
+//
+// Every row change made through the connection is captured by SQLite's update
+// hook and appended to an append-only journal as one line:
+//
+//     <unix time ms> TAB <operator> TAB <INSERT|UPDATE|DELETE> TAB <table> TAB <rowid>
+//
+// Records of an open transaction are held back until it commits, and
+// dropped on rollback. The connection runs in WAL mode because SQLite calls
+// the WAL hook only after a commit has succeeded, and that hook releases the
+// records. A COMMIT that fails (say with SQLITE_BUSY) leaves them pending
+// until the transaction is retried or rolled back. Committed records are
+// written and fsynced by a background thread in groups, so the booking path
+// never waits for a second fsync. A crash can lose at most
+// AUDIT_FLUSH_INTERVAL_MS worth of audit records, never a booking. The
+// admin program loads the journal into an indexed table.
+typedef struct {
+    char *data;
+    size_t len, cap;
+} AuditBuffer;
+
+static struct {
+    FILE *file;
+    char operator_name[64];
+    AuditBuffer pending; // Current transaction, touched only by the DB thread
+    AuditBuffer ready;   // Committed, waiting for the flusher
+    long long oldest_ready_ms;
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t flusher;
+} audit;
+
+static long long audit_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void audit_buffer_append(AuditBuffer *buf, const char *data, size_t len) {
+    if (buf->len + len > buf->cap) {
+        size_t cap = buf->cap ? buf->cap * 2 : 4096;
+        while (cap < buf->len + len) cap *= 2;
+        char *grown = realloc(buf->data, cap);
+        if (grown == NULL) return; // Out of memory: drop the record rather than the booking
+        buf->data = grown;
+        buf->cap = cap;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+static void audit_update_hook(void *arg, int op, const char *db_name, const char *table, sqlite3_int64 rowid) {
+    (void)arg; (void)db_name;
+    if (strcmp(table, "sqlite_sequence") == 0) return;
+
+    const char *action = op == SQLITE_INSERT ? "INSERT" : op == SQLITE_UPDATE ? "UPDATE" : "DELETE";
+    char record[256];
+    int len = snprintf(record, sizeof(record), "%lld\t%s\t%s\t%s\t%lld\n",
+                       audit_now_ms(), audit.operator_name, action, table, (long long)rowid);
+    if (len > 0 && len < (int)sizeof(record)) {
+        audit_buffer_append(&audit.pending, record, len);
+    }
+}
+
+// Hands the records of a committed transaction to the flusher
+static void audit_publish() {
+    if (audit.pending.len == 0) return;
+
+    pthread_mutex_lock(&audit.lock);
+    // Wake the flusher for the first record of a group, so it starts the
+    // interval timer, and again once the group is full
+    int was_empty = audit.ready.len == 0;
+    if (was_empty) audit.oldest_ready_ms = audit_now_ms();
+    audit_buffer_append(&audit.ready, audit.pending.data, audit.pending.len);
+    if (was_empty || audit.ready.len >= AUDIT_FLUSH_BYTES) pthread_cond_signal(&audit.wake);
+    pthread_mutex_unlock(&audit.lock);
+
+    audit.pending.len = 0;
+}
+
+// Called after a commit is in the WAL. Installing it replaces SQLite's
+// auto-checkpoint, so it also checkpoints at the default threshold.
+static int audit_wal_hook(void *arg, sqlite3 *conn, const char *db_name, int pages) {
+    (void)arg;
+    audit_publish();
+    if (pages >= AUDIT_WAL_CHECKPOINT_PAGES) {
+        sqlite3_wal_checkpoint_v2(conn, db_name, SQLITE_CHECKPOINT_PASSIVE, NULL, NULL);
+    }
+    return SQLITE_OK;
+}
+
+// Fallback when WAL is unavailable. It runs before the commit is durable,
+// so a COMMIT that then fails is still journaled.
+static int audit_commit_hook(void *arg) {
+    (void)arg;
+    audit_publish();
+    return 0; // Never veto the commit
+}
+
+static void audit_rollback_hook(void *arg) {
+    (void)arg;
+    audit.pending.len = 0;
+}
+
+// Flusher thread: sleeps until a group is due, then swaps buffers so writers
+// can keep appending while the group is written and fsynced.
+static void *audit_flusher(void *arg) {
+    (void)arg;
+    AuditBuffer group = {0};
+
+    pthread_mutex_lock(&audit.lock);
+    while (1) {
+        while (!audit.stop && audit.ready.len == 0) {
+            pthread_cond_wait(&audit.wake, &audit.lock);
+        }
+        if (!audit.stop && audit.ready.len < AUDIT_FLUSH_BYTES) {
+            long long due_ms = audit.oldest_ready_ms + AUDIT_FLUSH_INTERVAL_MS;
+            struct timespec due = { due_ms / 1000, (due_ms % 1000) * 1000000 };
+            if (pthread_cond_timedwait(&audit.wake, &audit.lock, &due) == 0) continue;
+        }
+        if (audit.ready.len == 0) break; // Stopping with nothing left
+
+        AuditBuffer swap = audit.ready;
+        audit.ready = group;
+        group = swap;
+        pthread_mutex_unlock(&audit.lock);
+
+        fwrite(group.data, 1, group.len, audit.file);
+        fflush(audit.file);
+        fsync(fileno(audit.file));
+        group.len = 0;
+
+        pthread_mutex_lock(&audit.lock);
+    }
+    pthread_mutex_unlock(&audit.lock);
+
+    free(group.data);
+    return NULL;
+}
+
+void audit_open(const char *path) {
+    audit.file = fopen(path, "ab");
+    if (audit.file == NULL) {
+        fprintf(stderr, "Audit journal error: cannot open %s\n", path);
+        return;
+    }
+
+    const char *name = getenv("CAMS_OPERATOR");
+    if (name == NULL) name = getenv("USER");
+    if (name == NULL) name = getenv("USERNAME");
+    snprintf(audit.operator_name, sizeof(audit.operator_name), "%s", name ? name : "unknown");
+    for (char *c = audit.operator_name; *c; c++) {
+        if (*c == '\t' || *c == '\n') *c = ' ';
+    }
+
+    pthread_mutex_init(&audit.lock, NULL);
+    pthread_cond_init(&audit.wake, NULL);
+    if (pthread_create(&audit.flusher, NULL, audit_flusher, NULL) != 0) {
+        fprintf(stderr, "Audit journal error: cannot start flusher thread\n");
+        fclose(audit.file);
+        audit.file = NULL;
+        return;
+    }
+
+    sqlite3_stmt *stmt;
+    int wal = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA journal_mode = WAL;", -1, &stmt, NULL) == SQLITE_OK) {
+        wal = sqlite3_step(stmt) == SQLITE_ROW &&
+              strcasecmp((const char *)sqlite3_column_text(stmt, 0), "wal") == 0;
+        sqlite3_finalize(stmt);
+    }
+
+    sqlite3_update_hook(db, audit_update_hook, NULL);
+    if (wal) {
+        sqlite3_wal_hook(db, audit_wal_hook, NULL);
+    } else {
+        fprintf(stderr, "Audit journal warning: WAL mode unavailable, failed commits may be journaled\n");
+        sqlite3_commit_hook(db, audit_commit_hook, NULL);
+    }
+    sqlite3_rollback_hook(db, audit_rollback_hook, NULL);
+    atexit(audit_close);
+}
+
+void audit_close() {
+    if (audit.file == NULL) return;
+
+    sqlite3_update_hook(db, NULL, NULL);
+    sqlite3_wal_hook(db, NULL, NULL);
+    sqlite3_commit_hook(db, NULL, NULL);
+    sqlite3_rollback_hook(db, NULL, NULL);
+
+    pthread_mutex_lock(&audit.lock);
+    audit.stop = 1;
+    pthread_cond_signal(&audit.wake);
+    pthread_mutex_unlock(&audit.lock);
+    pthread_join(audit.flusher, NULL);
+
+    fclose(audit.file);
+    audit.file = NULL;
+    free(audit.pending.data);
+    free(audit.ready.data);
+}
+
 // Main Menu
 void show_main_menu() {
     int choice;
@@ -152,7 +605,8 @@ void show_main_menu() {
         clear_screen();
         printf("=================================================\n");
         printf("    CLINIC APPOINTMENT MANAGEMENT SYSTEM (CAGS)  \n");
-        printf("==================================================\n\n");
+        printf("==================================================\n");
+        printf("Branch: %s\n\n", branch_name);
         printf("1. Goto Receptionist Section\n");
         printf("2. Goto Admin Section\n");
         printf("0. Exit\n");
@@ -229,6 +683,7 @@ void patient_management_menu() {
         printf("2. Edit Patient\n");
         printf("3. Delete Patient\n");
         printf("4. View All Patients\n");
+        printf("5. Patient Appointment History\n");
         printf("0. Back\n");
         printf("Enter your choice: ");
 
@@ -240,6 +695,7 @@ void patient_management_menu() {
             case 2: edit_patient(); break;
             case 3: delete_patient(); break;
             case 4: view_patients(); break;
+            case 5: view_patient_history(); break;
             case 0: return;
             default: 
                 printf("Invalid choice!\n");
@@ -512,15 +968,23 @@ void add_doc() {
 
     getString(name, MAX_STRING, "Full Name: ");
     getContactNumber(contact, "Contact Number (10 digits only): ");
+    list_specializations();
     getString(specialization, MAX_STRING, "Specialization: ");
 
-    char sql[512];
+    int specialization_id = intern_specialization(specialization);
+    if (specialization_id < 0) {
+        wait_for_enter();
+        return;
+    }
+
+    char sql[1024];
     snprintf(sql, sizeof(sql),
-             "INSERT INTO doctors (full_name, specialization, contact) "
-             "VALUES ('%s', '%s', '%s');",
-             name, specialization, contact);
+             "INSERT INTO doctors (full_name, specialization, specialization_id, contact) "
+             "VALUES ('%s', '%s', %d, '%s');",
+             name, specialization_name(specialization_id), specialization_id, contact);
 
     execute_sql(db, sql);
+    invalidate_doctor_names();
     printf("\nDoctor added successfully.\n");
     wait_for_enter();
 }
@@ -528,7 +992,7 @@ void add_doc() {
 void view_docs() {
     clear_screen();
     printf("=== VIEW ALL DOCTORS ===\n");
-    const char *sql = "SELECT * FROM doctors;";
+    const char *sql = "SELECT doctor_id, full_name, specialization_id, contact FROM doctors;";
     sqlite3_stmt *stmt;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
@@ -543,7 +1007,7 @@ void view_docs() {
     while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
         int doctor_id = sqlite3_column_int(stmt, 0);
         const char *full_name = (const char*)sqlite3_column_text(stmt, 1);
-        const char *specialization = (const char*)sqlite3_column_text(stmt, 2);
+        const char *specialization = specialization_name(sqlite3_column_int(stmt, 2));
         const char *contact = (const char*)sqlite3_column_text(stmt, 3);
 
         printf("%-5d %-25s %-20s %-15s\n",
@@ -603,14 +1067,21 @@ void edit_doc() {
 
     printf("\nEnter NEW details for Doctor ID %d (press Enter to keep current value):\n", doctor_id_to_edit);
     getString(name, MAX_STRING, "Full Name: ");
+    list_specializations();
     getString(specialization, MAX_STRING, "Specialization: "); 
     getContactNumber(contact, "Contact Number (10 digits only): ");
 
+    int specialization_id = intern_specialization(specialization);
+    if (specialization_id < 0) {
+        wait_for_enter();
+        return;
+    }
+
     // Update doctor details
-    char sql_update[512];
+    char sql_update[1024];
     snprintf(sql_update, sizeof(sql_update),
-             "UPDATE doctors SET full_name = '%s', specialization = '%s', contact = '%s' WHERE doctor_id = %d;",
-             name, specialization, contact, doctor_id_to_edit);
+             "UPDATE doctors SET full_name = '%s', specialization = '%s', specialization_id = %d, contact = '%s' WHERE doctor_id = %d;",
+             name, specialization_name(specialization_id), specialization_id, contact, doctor_id_to_edit);
     sqlite3_stmt *stmt_update;
 
     if (sqlite3_prepare_v2(db, sql_update, -1, &stmt_update, NULL) != SQLITE_OK) {
@@ -621,6 +1092,7 @@ void edit_doc() {
     if (sqlite3_step(stmt_update) != SQLITE_DONE) {
         fprintf(stderr, "Error updating doctor: %s\n", sqlite3_errmsg(db));
     } else {
+        invalidate_doctor_names();
         printf("Doctor details updated successfully.\n");
     }
 
@@ -716,6 +1188,9 @@ void appointment_management_menu() {
         printf("2. Edit Appointment\n");
         printf("3. Delete Appointment\n");
         printf("4. View All Appointments\n");
+        printf("5. Add Patient to Waitlist\n");
+        printf("6. View Waitlist\n");
+        printf("7. Remove Waitlist Entry\n");
         printf("0. Back\n");
         printf("Enter your choice: ");
 
@@ -727,6 +1202,9 @@ void appointment_management_menu() {
             case 2: edit_appointment(); break;
             case 3: cancel_appointment(); break;
             case 4: view_appointments(); break;
+            case 5: add_to_waitlist(); break;
+            case 6: view_waitlist(); break;
+            case 7: remove_from_waitlist(); break;
             case 0: return;
             default: 
                 printf("Invalid choice!\n");
@@ -736,6 +1214,85 @@ void appointment_management_menu() {
     }
 }
 
+// Appointment Operations
+//
+// The booking, edit and cancel logic shared by the menus and command mode.
+// They report problems on stderr and return 0 on success, -1 on failure.
+
+// Books an appointment; stores the new appointment ID in *appointment_id
+int book_appointment(int patient_id, int doctor_id, const char *date, const char *time, long long *appointment_id) {
+    if (!getRecordCount("patients", "patient_id", patient_id)) {
+        fprintf(stderr, "Patient with ID %d does not exist.\n", patient_id);
+        return -1;
+    }
+    if (!getRecordCount("doctors", "doctor_id", doctor_id)) {
+        fprintf(stderr, "Doctor with ID %d does not exist.\n", doctor_id);
+        return -1;
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db,
+            "INSERT INTO appointments (patient_id, doctor_id, appointment_date, appointment_time) "
+            "VALUES (?, ?, ?, ?);", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, patient_id);
+    sqlite3_bind_int(stmt, 2, doctor_id);
+    sqlite3_bind_text(stmt, 3, date, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, time, -1, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to schedule appointment: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    if (appointment_id != NULL) *appointment_id = sqlite3_last_insert_rowid(db);
+    return 0;
+}
+
+// Moves an appointment; a doctor_id of 0 or a NULL date/time keeps the current value.
+// Refused when another appointment already holds the resulting doctor slot.
+int update_appointment(int appointment_id, int doctor_id, const char *date, const char *time) {
+    if (doctor_id > 0 && !getRecordCount("doctors", "doctor_id", doctor_id)) {
+        fprintf(stderr, "Doctor with ID %d does not exist.\n", doctor_id);
+        return -1;
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db,
+            "UPDATE appointments SET doctor_id = COALESCE(?2, doctor_id), "
+            "appointment_date = COALESCE(?3, appointment_date), "
+            "appointment_time = COALESCE(?4, appointment_time) "
+            "WHERE appointment_id = ?1 AND NOT EXISTS (SELECT 1 FROM appointments o "
+            "WHERE o.appointment_id <> ?1 "
+            "AND o.doctor_id = COALESCE(?2, appointments.doctor_id) "
+            "AND o.appointment_date = COALESCE(?3, appointments.appointment_date) "
+            "AND o.appointment_time = COALESCE(?4, appointments.appointment_time));", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, appointment_id);
+    if (doctor_id > 0) sqlite3_bind_int(stmt, 2, doctor_id);
+    if (date != NULL) sqlite3_bind_text(stmt, 3, date, -1, SQLITE_STATIC);
+    if (time != NULL) sqlite3_bind_text(stmt, 4, time, -1, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to update appointment: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    if (sqlite3_changes(db) == 0) {
+        if (getRecordCount("appointments", "appointment_id", appointment_id)) {
+            fprintf(stderr, "The doctor is already booked at that date and time.\n");
+        } else {
+            fprintf(stderr, "Appointment with ID %d does not exist.\n", appointment_id);
+        }
+        return -1;
+    }
+    return 0;
+}
+
 void schedule_appointment() {
     int patient_id, doctor_id;
     char appointment_date[11], appointment_time[6];
@@ -827,18 +1384,9 @@ void schedule_appointment() {
     }
  */
 
-    // Prepare the SQL insert statement
-    char sql_insert[512];
-    snprintf(sql_insert, sizeof(sql_insert),
-             "INSERT INTO appointments (patient_id, doctor_id, appointment_date, appointment_time) "
-             "VALUES (%d, %d, '%s', '%s');",
-             patient_id, doctor_id, appointment_date, appointment_time);
-
-    execute_sql(db, sql_insert);
-
-    // Check if the insertion was successful
-    if (sqlite3_changes(db) > 0) {
-        printf("\nAppointment scheduled successfully.\n");
+    long long appointment_id;
+    if (book_appointment(patient_id, doctor_id, appointment_date, appointment_time, &appointment_id) == 0) {
+        printf("\nAppointment scheduled successfully (ID %lld).\n", appointment_id);
     } else {
         printf("\nFailed to schedule appointment. This might be due to a database error or constraint violation.\n");
     }
@@ -950,33 +1498,286 @@ void cancel_appointment() {
         return;
     }
 
-    // Prepare and execute the DELETE SQL statement
-    char sql_delete[256];
-    snprintf(sql_delete, sizeof(sql_delete),
-             "DELETE FROM appointments WHERE appointment_id = %d;",
-             appointment_id_to_cancel);
+    int filled_patient_id = 0;
+    if (cancel_and_fill_slot(appointment_id_to_cancel, &filled_patient_id) != SQLITE_OK) {
+        printf("Failed to cancel appointment ID %d.\n", appointment_id_to_cancel);
+    } else {
+        printf("Appointment ID %d has been successfully cancelled.\n", appointment_id_to_cancel);
+        if (filled_patient_id > 0) {
+            printf("The freed slot was booked for waitlisted Patient ID %d.\n", filled_patient_id);
+        }
+    }
 
-    sqlite3_stmt *stmt_delete;
-    if (sqlite3_prepare_v2(db, sql_delete, -1, &stmt_delete, NULL) != SQLITE_OK) {
+    wait_for_enter();
+}
+
+// Deletes the appointment and, in the same transaction, books the freed slot
+// for the best matching waitlist entry: a request for the same doctor or for
+// any doctor of the same specialization whose earliest acceptable date is on
+// or before the slot date. Among matches the patient who has been ready the
+// longest (earliest date, then oldest entry) wins. Past slots are not refilled.
+// The patient who cancelled, and anyone already booked at that date and time,
+// are passed over.
+int cancel_and_fill_slot(int appointment_id, int *filled_patient_id) {
+    const char *sql_slot =
+        "SELECT a.doctor_id, a.appointment_date, a.appointment_time, d.specialization_id, "
+        "a.appointment_date >= date('now', 'localtime'), a.patient_id "
+        "FROM appointments a JOIN doctors d ON a.doctor_id = d.doctor_id "
+        "WHERE a.appointment_id = ?;";
+    const char *sql_match =
+        "SELECT waitlist_id, patient_id FROM ("
+        "  SELECT * FROM (SELECT waitlist_id, patient_id, earliest_date FROM waitlist w "
+        "                 WHERE doctor_id = ?1 AND earliest_date <= ?2 AND patient_id <> ?4 "
+        "                 AND NOT EXISTS (SELECT 1 FROM appointments b WHERE b.patient_id = w.patient_id "
+        "                                 AND b.appointment_date = ?2 AND b.appointment_time = ?5) "
+        "                 ORDER BY earliest_date, waitlist_id LIMIT 1) "
+        "  UNION ALL "
+        "  SELECT * FROM (SELECT waitlist_id, patient_id, earliest_date FROM waitlist w "
+        "                 WHERE doctor_id IS NULL AND specialization_id = ?3 AND earliest_date <= ?2 "
+        "                 AND patient_id <> ?4 "
+        "                 AND NOT EXISTS (SELECT 1 FROM appointments b WHERE b.patient_id = w.patient_id "
+        "                                 AND b.appointment_date = ?2 AND b.appointment_time = ?5) "
+        "                 ORDER BY earliest_date, waitlist_id LIMIT 1)"
+        ") ORDER BY earliest_date, waitlist_id LIMIT 1;";
+    sqlite3_stmt *stmt = NULL;
+    int doctor_id = 0, specialization_id = 0, refill = 0, waitlist_id = 0, patient_id = 0;
+    int cancelled_patient_id = 0;
+    char date[11] = "", time[6] = "";
+    int rc;
+
+    *filled_patient_id = 0;
+
+    // Inside a script transaction this runs as a savepoint of it
+    int nested = !sqlite3_get_autocommit(db);
+    rc = sqlite3_exec(db, nested ? "SAVEPOINT cancel_slot;" : "BEGIN IMMEDIATE;", 0, 0, 0);
+    if (rc != SQLITE_OK) return rc;
+
+    // Remember the slot before it disappears
+    rc = sqlite3_prepare_v2(db, sql_slot, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) goto rollback;
+    sqlite3_bind_int(stmt, 1, appointment_id);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        doctor_id = sqlite3_column_int(stmt, 0);
+        snprintf(date, sizeof(date), "%s", (const char *)sqlite3_column_text(stmt, 1));
+        snprintf(time, sizeof(time), "%s", (const char *)sqlite3_column_text(stmt, 2));
+        specialization_id = sqlite3_column_int(stmt, 3);
+        refill = sqlite3_column_int(stmt, 4);
+        cancelled_patient_id = sqlite3_column_int(stmt, 5);
+    }
+    sqlite3_finalize(stmt);
+
+    rc = sqlite3_prepare_v2(db, "DELETE FROM appointments WHERE appointment_id = ?;", -1, &stmt, NULL);
+    if (rc != SQLITE_OK) goto rollback;
+    sqlite3_bind_int(stmt, 1, appointment_id);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) goto rollback;
+
+    if (refill) {
+        rc = sqlite3_prepare_v2(db, sql_match, -1, &stmt, NULL);
+        if (rc != SQLITE_OK) goto rollback;
+        sqlite3_bind_int(stmt, 1, doctor_id);
+        sqlite3_bind_text(stmt, 2, date, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 3, specialization_id);
+        sqlite3_bind_int(stmt, 4, cancelled_patient_id);
+        sqlite3_bind_text(stmt, 5, time, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            waitlist_id = sqlite3_column_int(stmt, 0);
+            patient_id = sqlite3_column_int(stmt, 1);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    if (waitlist_id > 0) {
+        rc = sqlite3_prepare_v2(db,
+            "INSERT INTO appointments (patient_id, doctor_id, appointment_date, appointment_time) "
+            "VALUES (?, ?, ?, ?);", -1, &stmt, NULL);
+        if (rc != SQLITE_OK) goto rollback;
+        sqlite3_bind_int(stmt, 1, patient_id);
+        sqlite3_bind_int(stmt, 2, doctor_id);
+        sqlite3_bind_text(stmt, 3, date, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, time, -1, SQLITE_STATIC);
+        rc = sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) goto rollback;
+
+        rc = sqlite3_prepare_v2(db, "DELETE FROM waitlist WHERE waitlist_id = ?;", -1, &stmt, NULL);
+        if (rc != SQLITE_OK) goto rollback;
+        sqlite3_bind_int(stmt, 1, waitlist_id);
+        rc = sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) goto rollback;
+    }
+
+    rc = sqlite3_exec(db, nested ? "RELEASE cancel_slot;" : "COMMIT;", 0, 0, 0);
+    if (rc != SQLITE_OK) goto rollback;
+
+    *filled_patient_id = patient_id;
+    return SQLITE_OK;
+
+rollback:
+    fprintf(stderr, "Cancellation rolled back: %s\n", sqlite3_errmsg(db));
+    sqlite3_exec(db, nested ? "ROLLBACK TO cancel_slot; RELEASE cancel_slot;" : "ROLLBACK;", 0, 0, 0);
+    return rc == SQLITE_OK ? SQLITE_ERROR : rc;
+}
+
+// Waitlist Management
+void add_to_waitlist() {
+    int patient_id, doctor_id = 0, specialization_id = 0;
+    char specialization[MAX_STRING], earliest_date[MAX_STRING];
+
+    clear_screen();
+    printf("=== ADD PATIENT TO WAITLIST ===\n");
+
+    patient_id = getPositiveInt("Enter Patient ID: ");
+    if (!getRecordCount("patients", "patient_id", patient_id)) {
+        printf("Patient with ID %d does not exist.\n", patient_id);
+        wait_for_enter();
+        return;
+    }
+
+    printf("Enter Doctor ID (0 to accept any doctor of a specialization): ");
+    if (scanf("%d", &doctor_id) != 1 || doctor_id < 0) {
+        printf("Invalid input. Please enter a number.\n");
+        clear_input_buffer();
+        wait_for_enter();
+        return;
+    }
+    clear_input_buffer();
+
+    if (doctor_id > 0 && !getRecordCount("doctors", "doctor_id", doctor_id)) {
+        printf("Doctor with ID %d does not exist.\n", doctor_id);
+        wait_for_enter();
+        return;
+    }
+    if (doctor_id == 0) {
+        list_specializations();
+        getString(specialization, MAX_STRING, "Specialization: ");
+        specialization_id = find_specialization(specialization);
+        if (specialization_id == 0) {
+            printf("No doctor has the specialization %s.\n", specialization);
+            wait_for_enter();
+            return;
+        }
+    }
+    getString(earliest_date, MAX_STRING, "Earliest Acceptable Date (YYYY-MM-DD): ");
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db,
+            "INSERT INTO waitlist (patient_id, doctor_id, specialization, specialization_id, earliest_date) "
+            "VALUES (?, ?, ?, ?, ?);", -1, &stmt, NULL) != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        wait_for_enter();
         return;
     }
+    sqlite3_bind_int(stmt, 1, patient_id);
+    if (doctor_id > 0) {
+        sqlite3_bind_int(stmt, 2, doctor_id);
+        sqlite3_bind_null(stmt, 3);
+        sqlite3_bind_null(stmt, 4);
+    } else {
+        sqlite3_bind_null(stmt, 2);
+        sqlite3_bind_text(stmt, 3, specialization_name(specialization_id), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 4, specialization_id);
+    }
+    sqlite3_bind_text(stmt, 5, earliest_date, -1, SQLITE_STATIC);
 
-    if (sqlite3_step(stmt_delete) != SQLITE_DONE) {
-        fprintf(stderr, "Error deleting appointment: %s\n", sqlite3_errmsg(db));
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "Error adding waitlist entry: %s\n", sqlite3_errmsg(db));
     } else {
-        printf("Appointment ID %d has been successfully cancelled.\n", appointment_id_to_cancel);
+        printf("\nPatient ID %d added to the waitlist (entry ID %lld).\n",
+               patient_id, (long long)sqlite3_last_insert_rowid(db));
     }
+    sqlite3_finalize(stmt);
+    wait_for_enter();
+}
 
-    sqlite3_finalize(stmt_delete);
+void view_waitlist() {
+    clear_screen();
+    printf("=== VIEW WAITLIST ===\n");
+    const char *sql = "SELECT w.waitlist_id, p.full_name, COALESCE(d.full_name, 'ANY'), "
+                      "COALESCE(w.specialization_id, d.specialization_id), w.earliest_date, w.created_at "
+                      "FROM waitlist w "
+                      "JOIN patients p ON w.patient_id = p.patient_id "
+                      "LEFT JOIN doctors d ON w.doctor_id = d.doctor_id "
+                      "ORDER BY w.earliest_date, w.waitlist_id;";
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    printf("\n%-5s %-25s %-25s %-20s %-12s %-20s\n", "ID", "Patient Name", "Doctor Name", "Specialization", "Earliest", "Waiting Since");
+    printf("----- ------------------------- ------------------------- -------------------- ------------ --------------------\n");
+
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        printf("%-5d %-25s %-25s %-20s %-12s %-20s\n",
+               sqlite3_column_int(stmt, 0),
+               (const char *)sqlite3_column_text(stmt, 1),
+               (const char *)sqlite3_column_text(stmt, 2),
+               specialization_name(sqlite3_column_int(stmt, 3)),
+               (const char *)sqlite3_column_text(stmt, 4),
+               (const char *)sqlite3_column_text(stmt, 5));
+    }
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+
+    sqlite3_finalize(stmt);
+    printf("\nEnd of waitlist.\n");
+    wait_for_enter();
+}
+
+void remove_from_waitlist() {
+    clear_screen();
+    printf("=== REMOVE WAITLIST ENTRY ===\n");
+
+    int waitlist_id = getPositiveInt("Enter the ID of the waitlist entry to remove: ");
+
+    char sql_delete[256];
+    snprintf(sql_delete, sizeof(sql_delete),
+             "DELETE FROM waitlist WHERE waitlist_id = %d;", waitlist_id);
+    execute_sql(db, sql_delete);
+
+    if (sqlite3_changes(db) > 0) {
+        printf("\nWaitlist entry %d removed.\n", waitlist_id);
+    } else {
+        printf("\nWaitlist entry %d not found.\n", waitlist_id);
+    }
     wait_for_enter();
 }
 
 void edit_appointment() {
+    char date[16], time[16];
+
     clear_screen();
-    printf("=== Menu Under Construction ===\n");
-    printf("This feature is currently under construction.\n");
-    printf("Please check back later.\n");
+    printf("=== EDIT APPOINTMENT ===\n");
+
+    int appointment_id = getPositiveInt("Enter the ID of the appointment you want to edit: ");
+    if (!getRecordCount("appointments", "appointment_id", appointment_id)) {
+        printf("Appointment with ID %d does not exist.\n", appointment_id);
+        wait_for_enter();
+        return;
+    }
+
+    printf("\nEnter NEW details for Appointment ID %d (0 or Enter keeps the current value):\n", appointment_id);
+    printf("Doctor ID: ");
+    int doctor_id = 0;
+    if (scanf("%d", &doctor_id) != 1 || doctor_id < 0) doctor_id = 0;
+    clear_input_buffer();
+    printf("Appointment Date (YYYY-MM-DD): ");
+    if (fgets(date, sizeof(date), stdin) == NULL) date[0] = 0;
+    date[strcspn(date, "\n")] = 0;
+    printf("Appointment Time (HH:MM): ");
+    if (fgets(time, sizeof(time), stdin) == NULL) time[0] = 0;
+    time[strcspn(time, "\n")] = 0;
+
+    if (update_appointment(appointment_id, doctor_id, date[0] ? date : NULL, time[0] ? time : NULL) == 0) {
+        printf("\nAppointment updated successfully.\n");
+    }
     wait_for_enter();
 }
 
@@ -998,6 +1799,12 @@ void clear_input_buffer() {
     while (getchar() != '\n');
 }
 
+double monotonic_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
 void to_uppercase(char *str) {
     if (str == NULL) return; // Check for NULL pointer
     for (int i = 0; str[i]; i++) {
@@ -1125,4 +1932,452 @@ void getContactNumber(char *contact, const char *message) {
     }
 }
 
+// Patient History
+//
+// A patient's appointments come straight out of idx_appointments_patient,
+// which holds every column the history needs, so the lookup is one index
+// range read however large the appointments table grows. Doctor names come
+// from an in-memory map (doctor ID -> name) that is loaded on first use and
+// reloaded after a doctor is added or edited.
+static struct {
+    char **names;   // Indexed by doctor_id, NULL if there is no such doctor
+    int size;
+    int stale;
+} doctor_names = {NULL, 0, 1};
+
+void invalidate_doctor_names() {
+    doctor_names.stale = 1;
+}
+
+static void load_doctor_names() {
+    for (int i = 0; i < doctor_names.size; i++) free(doctor_names.names[i]);
+    free(doctor_names.names);
+    doctor_names.names = NULL;
+    doctor_names.size = 0;
+    doctor_names.stale = 0;
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT doctor_id, full_name FROM doctors ORDER BY doctor_id DESC;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        const char *name = (const char *)sqlite3_column_text(stmt, 1);
+        if (id < 0) continue;
+        if (doctor_names.names == NULL) {
+            // Highest ID comes first, so one allocation covers them all
+            doctor_names.names = calloc(id + 1, sizeof(char *));
+            if (!doctor_names.names) break;
+            doctor_names.size = id + 1;
+        }
+        doctor_names.names[id] = malloc(strlen(name) + 1);
+        if (doctor_names.names[id]) strcpy(doctor_names.names[id], name);
+    }
+    sqlite3_finalize(stmt);
+}
+
+const char *doctor_name(int doctor_id) {
+    if (doctor_names.stale) load_doctor_names();
+    if (doctor_id < 0 || doctor_id >= doctor_names.size || !doctor_names.names[doctor_id]) return "UNKNOWN";
+    return doctor_names.names[doctor_id];
+}
+
+void view_patient_history() {
+    clear_screen();
+    printf("=== PATIENT APPOINTMENT HISTORY ===\n");
+
+    int patient_id = getPositiveInt("Enter Patient ID: ");
 
+    sqlite3_stmt *stmt;
+    char patient_name[MAX_STRING] = "";
+    if (sqlite3_prepare_v2(db, "SELECT full_name FROM patients WHERE patient_id = ?;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        wait_for_enter();
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, patient_id);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        snprintf(patient_name, sizeof(patient_name), "%s", (const char *)sqlite3_column_text(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    if (patient_name[0] == '\0') {
+        printf("Patient with ID %d does not exist.\n", patient_id);
+        wait_for_enter();
+        return;
+    }
+
+    const char *sql =
+        "SELECT appointment_id, appointment_date, appointment_time, doctor_id, "
+        "appointment_date < date('now', 'localtime') "
+        "FROM appointments INDEXED BY idx_appointments_patient "
+        "WHERE patient_id = ? "
+        "ORDER BY appointment_date DESC, appointment_time DESC;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        wait_for_enter();
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, patient_id);
+
+    printf("\nPatient: %s (ID %d)\n", patient_name, patient_id);
+    printf("\n%-5s %-12s %-6s %-25s %-8s\n", "ID", "Date", "Time", "Doctor", "Status");
+    printf("----- ------------ ------ ------------------------- --------\n");
+
+    int count = 0, rc;
+    char last_seen[64] = "";
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int past = sqlite3_column_int(stmt, 4);
+        const char *date = (const char *)sqlite3_column_text(stmt, 1);
+        const char *name = doctor_name(sqlite3_column_int(stmt, 3));
+        printf("%-5d %-12s %-6s %-25s %-8s\n",
+               sqlite3_column_int(stmt, 0), date,
+               (const char *)sqlite3_column_text(stmt, 2),
+               name, past ? "Seen" : "Upcoming");
+        if (past && last_seen[0] == '\0') {
+            snprintf(last_seen, sizeof(last_seen), "%s by %.40s", date, name);
+        }
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+
+    printf("\n%d appointment(s).", count);
+    if (last_seen[0] != '\0') printf(" Last seen %s.", last_seen);
+    printf("\n");
+    wait_for_enter();
+}
+
+// Command Mode
+//
+// "app <command> [--option value ...]" runs one command without the menus
+// and exits, so it can be scheduled (cron, Task Scheduler). --branch picks
+// the branch as in interactive mode and is required when several branches
+// are registered.
+const char *get_option(int argc, char *argv[], const char *name) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strncmp(argv[i], "--", 2) == 0 && strcmp(argv[i] + 2, name) == 0) return argv[i + 1];
+    }
+    return NULL;
+}
+
+int run_command(int argc, char *argv[]) {
+    if (strcmp(argv[0], "book") == 0) return command_book(argc, argv);
+    if (strcmp(argv[0], "edit") == 0) return command_edit(argc, argv);
+    if (strcmp(argv[0], "cancel") == 0) return command_cancel(argc, argv);
+    if (strcmp(argv[0], "run") == 0) return command_run(argc, argv);
+    if (strcmp(argv[0], "reminders") == 0) return export_reminders(argc, argv);
+
+    fprintf(stderr, "Unknown command '%s'. Commands:\n", argv[0]);
+    fprintf(stderr, "  book --patient ID --doctor ID --date YYYY-MM-DD --time HH:MM\n");
+    fprintf(stderr, "  edit --id ID [--doctor ID] [--date YYYY-MM-DD] [--time HH:MM]\n");
+    fprintf(stderr, "  cancel --id ID\n");
+    fprintf(stderr, "  run FILE [--transaction]\n");
+    fprintf(stderr, "  reminders [--date YYYY-MM-DD] [--format csv|ndjson] [--out FILE]\n");
+    fprintf(stderr, "Every command also accepts --branch NAME.\n");
+    return 1;
+}
+
+// Parses --name as a positive integer; returns 0 if it is missing or invalid
+int get_int_option(int argc, char *argv[], const char *name) {
+    const char *value = get_option(argc, argv, name);
+    char *end;
+    if (value == NULL) return 0;
+    long number = strtol(value, &end, 10);
+    return (*end == '\0' && number > 0 && number <= 0x7FFFFFFF) ? (int)number : 0;
+}
+
+// app book --patient ID --doctor ID --date YYYY-MM-DD --time HH:MM
+int command_book(int argc, char *argv[]) {
+    int patient_id = get_int_option(argc, argv, "patient");
+    int doctor_id = get_int_option(argc, argv, "doctor");
+    const char *date = get_option(argc, argv, "date");
+    const char *time = get_option(argc, argv, "time");
+    long long appointment_id;
+
+    if (patient_id == 0 || doctor_id == 0 || date == NULL || time == NULL) {
+        fprintf(stderr, "Usage: book --patient ID --doctor ID --date YYYY-MM-DD --time HH:MM\n");
+        return 1;
+    }
+    if (book_appointment(patient_id, doctor_id, date, time, &appointment_id) != 0) return 1;
+    if (!script_mode) printf("Booked appointment %lld.\n", appointment_id);
+    return 0;
+}
+
+// app edit --id ID [--doctor ID] [--date YYYY-MM-DD] [--time HH:MM]
+int command_edit(int argc, char *argv[]) {
+    int appointment_id = get_int_option(argc, argv, "id");
+    int doctor_id = get_int_option(argc, argv, "doctor");
+    const char *date = get_option(argc, argv, "date");
+    const char *time = get_option(argc, argv, "time");
+
+    if (appointment_id == 0 || (doctor_id == 0 && date == NULL && time == NULL)) {
+        fprintf(stderr, "Usage: edit --id ID [--doctor ID] [--date YYYY-MM-DD] [--time HH:MM]\n");
+        return 1;
+    }
+    if (update_appointment(appointment_id, doctor_id, date, time) != 0) return 1;
+    if (!script_mode) printf("Updated appointment %d.\n", appointment_id);
+    return 0;
+}
+
+// app cancel --id ID (the freed slot goes to the waitlist as in the menus)
+int command_cancel(int argc, char *argv[]) {
+    int appointment_id = get_int_option(argc, argv, "id");
+    int filled_patient_id;
+
+    if (appointment_id == 0) {
+        fprintf(stderr, "Usage: cancel --id ID\n");
+        return 1;
+    }
+    if (!getRecordCount("appointments", "appointment_id", appointment_id)) {
+        fprintf(stderr, "Appointment with ID %d does not exist.\n", appointment_id);
+        return 1;
+    }
+    if (cancel_and_fill_slot(appointment_id, &filled_patient_id) != SQLITE_OK) return 1;
+    if (!script_mode) {
+        printf("Cancelled appointment %d.\n", appointment_id);
+        if (filled_patient_id > 0) printf("The freed slot was booked for waitlisted Patient ID %d.\n", filled_patient_id);
+    }
+    return 0;
+}
+
+// app run FILE [--transaction]
+//
+// Runs one command per line ('#' starts a comment), written as on the command
+// line without the program name. With --transaction the whole script is one
+// transaction: it is committed only if every command succeeds, otherwise
+// nothing is applied. Without it each command commits on its own and the
+// script carries on after a failure.
+int command_run(int argc, char *argv[]) {
+    const char *path = argc > 1 && argv[1][0] != '-' ? argv[1] : NULL;
+    int transaction = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--transaction") == 0) transaction = 1;
+    }
+    if (path == NULL) {
+        fprintf(stderr, "Usage: run FILE [--transaction]\n");
+        return 1;
+    }
+    if (script_mode) {
+        fprintf(stderr, "Scripts cannot run other scripts.\n");
+        return 1;
+    }
+
+    FILE *script = fopen(path, "r");
+    if (script == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+
+    if (transaction && sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "Cannot start transaction: %s\n", sqlite3_errmsg(db));
+        fclose(script);
+        return 1;
+    }
+
+    double started = monotonic_seconds();
+    char line[1024];
+    int line_no = 0, executed = 0, failed = 0;
+    script_mode = 1;
+    while (fgets(line, sizeof(line), script) != NULL) {
+        char *args[SCRIPT_MAX_ARGS];
+        int count = 0;
+
+        line_no++;
+        line[strcspn(line, "\r\n#")] = '\0';
+        for (char *token = strtok(line, " \t"); token != NULL && count < SCRIPT_MAX_ARGS; token = strtok(NULL, " \t")) {
+            args[count++] = token;
+        }
+        if (count == 0) continue;
+
+        executed++;
+        if (run_command(count, args) != 0) {
+            fprintf(stderr, "%s:%d: command failed\n", path, line_no);
+            failed++;
+            if (transaction) break;
+        }
+    }
+    script_mode = 0;
+    fclose(script);
+
+    if (transaction) {
+        if (failed) {
+            sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+            fprintf(stderr, "Script rolled back; no changes were made.\n");
+            return 1;
+        }
+        if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK) {
+            fprintf(stderr, "Commit failed: %s\n", sqlite3_errmsg(db));
+            sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+            return 1;
+        }
+    }
+
+    double elapsed = monotonic_seconds() - started;
+    printf("%d command(s) run, %d failed, in %.3f s", executed, failed, elapsed);
+    if (elapsed > 0) printf(" (%.0f/s)", executed / elapsed);
+    printf(".\n");
+    return failed ? 1 : 0;
+}
+
+// Appointment Reminders
+//
+// Streams one day's appointments (tomorrow by default) with the patient's
+// contact number and the doctor's name to a CSV or NDJSON file for the SMS
+// gateway. Rows come straight from the appointment_date index and are written
+// through a large stdio buffer. The file is written under a temporary name
+// and renamed when complete, so the gateway never picks up a partial batch.
+static void write_csv_field(FILE *out, const char *text, int last) {
+    if (text == NULL) text = "";
+    if (strpbrk(text, ",\"\r\n") != NULL) {
+        fputc('"', out);
+        for (const char *c = text; *c; c++) {
+            if (*c == '"') fputc('"', out);
+            fputc(*c, out);
+        }
+        fputc('"', out);
+    } else {
+        fputs(text, out);
+    }
+    fputc(last ? '\n' : ',', out);
+}
+
+static void write_json_string(FILE *out, const char *text) {
+    if (text == NULL) text = "";
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', out);
+            fputc(*c, out);
+        } else if (*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+int export_reminders(int argc, char *argv[]) {
+    const char *date_option = get_option(argc, argv, "date");
+    const char *format = get_option(argc, argv, "format");
+    const char *out_path = get_option(argc, argv, "out");
+    char date[11];
+    int ndjson;
+
+    if (format == NULL || strcasecmp(format, "csv") == 0) {
+        ndjson = 0;
+    } else if (strcasecmp(format, "ndjson") == 0) {
+        ndjson = 1;
+    } else {
+        fprintf(stderr, "Unknown format '%s' (use csv or ndjson).\n", format);
+        return 1;
+    }
+
+    if (date_option != NULL) {
+        int y, m, d;
+        if (strlen(date_option) != 10 || sscanf(date_option, "%4d-%2d-%2d", &y, &m, &d) != 3) {
+            fprintf(stderr, "Invalid date '%s'. Please use YYYY-MM-DD.\n", date_option);
+            return 1;
+        }
+        snprintf(date, sizeof(date), "%s", date_option);
+    } else {
+        time_t now = time(NULL);
+        struct tm tomorrow = *localtime(&now);
+        tomorrow.tm_mday++;
+        tomorrow.tm_isdst = -1;
+        mktime(&tomorrow);
+        strftime(date, sizeof(date), "%Y-%m-%d", &tomorrow);
+    }
+
+    const char *sql =
+        "SELECT a.appointment_id, a.appointment_date, a.appointment_time, "
+        "p.patient_id, p.full_name, p.contact, d.full_name "
+        "FROM appointments a "
+        "JOIN patients p ON p.patient_id = a.patient_id "
+        "JOIN doctors d ON d.doctor_id = a.doctor_id "
+        "WHERE a.appointment_date = ? "
+        "ORDER BY a.appointment_time, a.appointment_id;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return 1;
+    }
+    sqlite3_bind_text(stmt, 1, date, -1, SQLITE_STATIC);
+
+    char tmp_path[MAX_STRING + 8];
+    FILE *out = stdout;
+    if (out_path != NULL && strcmp(out_path, "-") != 0) {
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", out_path);
+        out = fopen(tmp_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Cannot write %s\n", tmp_path);
+            sqlite3_finalize(stmt);
+            return 1;
+        }
+    }
+    setvbuf(out, NULL, _IOFBF, REMINDER_BUFFER_SIZE);
+
+    double started = monotonic_seconds();
+    long long count = 0;
+    if (!ndjson) fputs("appointment_id,date,time,patient_id,patient_name,contact,doctor_name\n", out);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *appointment_date = (const char *)sqlite3_column_text(stmt, 1);
+        const char *appointment_time = (const char *)sqlite3_column_text(stmt, 2);
+        const char *patient_name = (const char *)sqlite3_column_text(stmt, 4);
+        const char *contact = (const char *)sqlite3_column_text(stmt, 5);
+        const char *doctor = (const char *)sqlite3_column_text(stmt, 6);
+        if (ndjson) {
+            fprintf(out, "{\"appointment_id\":%d,\"date\":", sqlite3_column_int(stmt, 0));
+            write_json_string(out, appointment_date);
+            fputs(",\"time\":", out);
+            write_json_string(out, appointment_time);
+            fprintf(out, ",\"patient_id\":%d,\"patient_name\":", sqlite3_column_int(stmt, 3));
+            write_json_string(out, patient_name);
+            fputs(",\"contact\":", out);
+            write_json_string(out, contact);
+            fputs(",\"doctor_name\":", out);
+            write_json_string(out, doctor);
+            fputs("}\n", out);
+        } else {
+            fprintf(out, "%d,", sqlite3_column_int(stmt, 0));
+            write_csv_field(out, appointment_date, 0);
+            write_csv_field(out, appointment_time, 0);
+            fprintf(out, "%d,", sqlite3_column_int(stmt, 3));
+            write_csv_field(out, patient_name, 0);
+            write_csv_field(out, contact, 0);
+            write_csv_field(out, doctor, 1);
+        }
+        count++;
+    }
+    sqlite3_finalize(stmt);
+
+    int failed = rc != SQLITE_DONE;
+    if (failed) fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    if (fflush(out) != 0) failed = 1;
+
+    int to_file = out != stdout;
+    if (to_file) {
+        if (fclose(out) != 0) failed = 1;
+        if (failed) {
+            remove(tmp_path);
+        } else {
+#ifdef _WIN32
+            remove(out_path); // rename() does not replace an existing file on Windows
+#endif
+            if (rename(tmp_path, out_path) != 0) {
+                fprintf(stderr, "Cannot rename %s to %s\n", tmp_path, out_path);
+                failed = 1;
+            }
+        }
+    }
+    if (failed) return 1;
+
+    fprintf(stderr, "%s: %lld reminder(s) for %s written to %s in %.2f s\n", branch_name, count, date,
+            to_file ? out_path : "stdout", monotonic_seconds() - started);
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Branch Registry
+//
+// Shared by the receptionist (app.c) and admin (main.c) programs, which are
+// each built from a single source file. Expects MAX_STRING, MAX_BRANCHES and
+// BRANCH_REGISTRY to be defined by the including program.
+//
+// branches.cfg lists the clinic branches, one per line as NAME=database file.
+// Lines starting with '#' are comments; a '#' anywhere else is part of the
+// value, since database paths may contain one. Lines whose name or path does
+// not fit are reported and skipped rather than truncated, so a branch never
+// silently opens the wrong file.
+//
+// Each branch's audit journal sits next to its database, named by
+// branch_journal_path.
+#ifndef BRANCH_REGISTRY_H
+#define BRANCH_REGISTRY_H
+
+#define BRANCH_NAME_SIZE 64
+
+typedef struct {
+    char name[BRANCH_NAME_SIZE]; // Upper-cased
+    char db_path[MAX_STRING];
+} BranchEntry;
+
+// Reads the registry into entries; returns the number of branches found,
+// 0 when there is no registry
+static int read_branch_registry(BranchEntry entries[], int max_entries) {
+    FILE *registry = fopen(BRANCH_REGISTRY, "r");
+    if (registry == NULL) return 0;
+
+    char line[BRANCH_NAME_SIZE + MAX_STRING + 2];
+    int count = 0, line_no = 0;
+    while (count < max_entries && fgets(line, sizeof(line), registry) != NULL) {
+        line_no++;
+        size_t len = strcspn(line, "\r\n");
+        if (line[len] == '\0' && !feof(registry)) {
+            // Longer than any valid entry: skip the rest of it
+            int c;
+            while ((c = fgetc(registry)) != '\n' && c != EOF);
+            fprintf(stderr, "%s:%d: line too long, ignored\n", BRANCH_REGISTRY, line_no);
+            continue;
+        }
+        line[len] = '\0';
+        if (line[0] == '#') continue;
+
+        char *eq = strchr(line, '=');
+        if (eq == NULL || eq == line || eq[1] == '\0') continue;
+        size_t name_len = (size_t)(eq - line);
+        size_t path_len = strlen(eq + 1);
+        if (name_len >= BRANCH_NAME_SIZE || path_len >= MAX_STRING) {
+            fprintf(stderr, "%s:%d: branch name or database path too long, ignored\n", BRANCH_REGISTRY, line_no);
+            continue;
+        }
+
+        BranchEntry *entry = &entries[count++];
+        for (size_t i = 0; i < name_len; i++) entry->name[i] = toupper((unsigned char)line[i]);
+        entry->name[name_len] = '\0';
+        memcpy(entry->db_path, eq + 1, path_len + 1);
+    }
+    fclose(registry);
+    return count;
+}
+
+// Journal path for a branch database: clinic.db -> clinic_audit.log. Only a
+// trailing ".db" is dropped, so data.db/north.sqlite gets
+// data.db/north.sqlite_audit.log.
+static void branch_journal_path(char *journal, size_t size, const char *db_path) {
+    size_t stem = strlen(db_path);
+    if (stem > 3 && strcmp(db_path + stem - 3, ".db") == 0) stem -= 3;
+    snprintf(journal, size, "%.*s_audit.log", (int)stem, db_path);
+}
+
+#endif
@@ -2,14 +2,50 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sqlite3.h>
+#include <ctype.h>
+#include <time.h>
+#include <stdint.h>
+#include <pthread.h>
+#ifdef _WIN32
+    #define fseek64 _fseeki64
+#else
+    #include <unistd.h> // For sysconf
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #define fseek64 fseeko
+#endif
 
 // Constants
 #define MAX_STRING 256
 #define MAX_APPOINTMENTS_PER_DAY 15
-#define DB_NAME "clinic.db"
+#define DB_NAME "clinic.db"           // Database of the single default branch
+#define BRANCH_REGISTRY "branches.cfg" // One "NAME=database file" line per clinic branch
+#define MAX_BRANCHES 32
+#define MAX_REPORT_THREADS 64
+#define PARTITIONS_PER_THREAD 4 // Extra partitions even out skew between busy and quiet periods
+#define CLINIC_OPEN_HOUR 9
+#define CLINIC_CLOSE_HOUR 17
+#define UTILIZATION_DEFAULT_WEEKS 12
+#define UTILIZATION_CSV "doctor_utilization.csv"
+#define SNAPSHOT_FILE "clinic_snapshot.cols"
+#define SNAPSHOT_MAGIC "CAMSCOL1"
+#define SNAPSHOT_CHUNK_ROWS 8192 // Rows buffered per column before they are written out
 
-// Global database connection
-sqlite3 *db;
+#include "branch_registry.h"
+#include "../common/schema_helpers.h"
+
+// Clinic branches. Every branch keeps its data in its own database file, so
+// admin reports open all of them and merge the per-branch results.
+typedef struct {
+    char name[BRANCH_NAME_SIZE];
+    char db_path[MAX_STRING];
+    char journal_path[MAX_STRING + 16]; // Receptionist audit journal of the branch
+    sqlite3 *db;
+} Branch;
+
+Branch branches[MAX_BRANCHES];
+int branch_count = 0;
 
 // User roles
 typedef enum {
@@ -22,12 +58,12 @@ void wait_for_enter();
 void clear_screen();
 void clear_input_buffer();
 
-/* 
 // DB Function Prototypes
-void connect_database();
+void connect_database(); // Opens every branch database listed in the branch registry
+void close_database();
 void initialize_database(sqlite3 *db);
+void migrate_specializations(sqlite3 *db); // Moves free-text specializations into the dictionary table
 void execute_sql(sqlite3 *db, const char *sql);
- */
 
 // Menu Functions
 void show_main_menu();
@@ -43,6 +79,28 @@ void view_appointments();
 void generate_daily_report();
 void generate_patient_list_by_doctor();
 void generate_appointment_trends();
+void get_report_date(char *date, const char *message); // Reads a YYYY-MM-DD date, defaulting to today
+void benchmark_appointment_trends();
+void generate_utilization_heatmap();
+
+// One doctor's row of the utilization matrix
+typedef struct {
+    int branch;
+    int doctor_id;
+    char doctor_name[MAX_STRING];
+    int counts[168]; // Appointments per hour of the week, Monday 00:00 first
+} UtilizationRow;
+
+// Analytics Snapshot Functions
+void snapshot_menu();
+void export_snapshot();
+void analyze_snapshot();
+
+// Audit Functions
+void audit_menu();
+void load_audit_journal();
+int load_branch_journal(Branch *branch, int *skipped);
+void query_audit_log();
 
 // Receptionist Functions
 void doctor_management_menu();
@@ -60,15 +118,42 @@ void schedule_appointment();
 void edit_appointment();
 void delete_appointment();
 
-/* 
 // Connect Database
+//
+// The registry is read by branch_registry.h, shared with the receptionist
+// program. Without one there is a single MAIN branch on clinic.db.
 void connect_database() {
-    int rc = sqlite3_open(DB_NAME, &db);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Database error: %s\n", sqlite3_errmsg(db));
-        exit(1);
+    BranchEntry entries[MAX_BRANCHES];
+    branch_count = read_branch_registry(entries, MAX_BRANCHES);
+    for (int i = 0; i < branch_count; i++) {
+        memcpy(branches[i].name, entries[i].name, sizeof(branches[i].name));
+        memcpy(branches[i].db_path, entries[i].db_path, sizeof(branches[i].db_path));
+    }
+    if (branch_count == 0) {
+        snprintf(branches[0].name, sizeof(branches[0].name), "MAIN");
+        snprintf(branches[0].db_path, sizeof(branches[0].db_path), "%s", DB_NAME);
+        branch_count = 1;
+    }
+
+    for (int i = 0; i < branch_count; i++) {
+        Branch *branch = &branches[i];
+
+        branch_journal_path(branch->journal_path, sizeof(branch->journal_path), branch->db_path);
+
+        if (sqlite3_open(branch->db_path, &branch->db) != SQLITE_OK) {
+            fprintf(stderr, "Database error (%s): %s\n", branch->name, sqlite3_errmsg(branch->db));
+            exit(1);
+        }
+        sqlite3_exec(branch->db, "PRAGMA foreign_keys = ON;", 0, 0, 0);
+        initialize_database(branch->db);
+    }
+}
+
+void close_database() {
+    for (int i = 0; i < branch_count; i++) {
+        sqlite3_close(branches[i].db);
+        branches[i].db = NULL;
     }
-    sqlite3_exec(db, "PRAGMA foreign_keys = ON;", 0, 0, 0);
 }
 
 // Initialize Database and Tables
@@ -84,24 +169,70 @@ void initialize_database(sqlite3 *db) {
         "gender TEXT CHECK(gender IN ('M','F','O'))"
         "); "
 
+        "CREATE TABLE IF NOT EXISTS specializations ("
+        "specialization_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "name TEXT NOT NULL UNIQUE COLLATE NOCASE"
+        "); "
+
+        // specialization keeps a copy of the dictionary name for older readers;
+        // lookups and grouping use specialization_id
         "CREATE TABLE IF NOT EXISTS doctors ("
         "doctor_id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "full_name TEXT NOT NULL, "
         "specialization TEXT NOT NULL, "
-        "contact TEXT NOT NULL"
+        "contact TEXT NOT NULL, "
+        "specialization_id INTEGER REFERENCES specializations(specialization_id)"
         "); "
 
         "CREATE TABLE IF NOT EXISTS appointments ("
         "appointment_id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "patient_id INTEGER NOT NULL, "
         "doctor_id INTEGER NOT NULL, "
-        "appointment_date TEXT NOT NULL CHECK(appointment_date GLOB '????-??-??'), "
-        "appointment_time TEXT NOT NULL CHECK(appointment_time GLOB '??:??'), "
+        "appointment_date TEXT NOT NULL CHECK(appointment_date GLOB '[0-9][0-9][0-9][0-9]-[0-9][0-9]-[0-9][0-9]'), "
+        "appointment_time TEXT NOT NULL CHECK(appointment_time GLOB '[0-9][0-9]:[0-9][0-9]'), "
         "FOREIGN KEY(patient_id) REFERENCES patients(patient_id) ON DELETE CASCADE, "
         "FOREIGN KEY(doctor_id) REFERENCES doctors(doctor_id) ON DELETE CASCADE"
+        "); "
+        "CREATE INDEX IF NOT EXISTS idx_appointments_date ON appointments(appointment_date); "
+
+        // Audit trail loaded from the receptionist program's journal
+        "CREATE TABLE IF NOT EXISTS audit_log ("
+        "audit_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "logged_at INTEGER NOT NULL, " // Unix time in milliseconds
+        "operator TEXT NOT NULL, "
+        "action TEXT NOT NULL CHECK(action IN ('INSERT','UPDATE','DELETE')), "
+        "table_name TEXT NOT NULL, "
+        "record_id INTEGER NOT NULL"
+        "); "
+        "CREATE INDEX IF NOT EXISTS idx_audit_record ON audit_log(table_name, record_id, logged_at); "
+        "CREATE INDEX IF NOT EXISTS idx_audit_operator ON audit_log(operator, logged_at); "
+        "CREATE INDEX IF NOT EXISTS idx_audit_time ON audit_log(logged_at); "
+
+        // How far each journal file has been loaded, so reloading is incremental
+        "CREATE TABLE IF NOT EXISTS audit_journal_state ("
+        "journal TEXT PRIMARY KEY, "
+        "loaded_offset INTEGER NOT NULL"
         ");";
 
     execute_sql(db, sql);
+    migrate_specializations(db);
+}
+
+// Same migration as the receptionist program, so a branch database is
+// upgraded by whichever program opens it first. Specialization IDs are local
+// to a branch; cross-branch reports join the dictionary for the name.
+void migrate_specializations(sqlite3 *db) {
+    if (!column_exists(db, "doctors", "specialization_id")) {
+        execute_sql(db, "ALTER TABLE doctors ADD COLUMN specialization_id INTEGER REFERENCES specializations(specialization_id);");
+    }
+
+    run_migration(db,
+        "INSERT OR IGNORE INTO specializations (name) "
+        "SELECT TRIM(specialization) FROM doctors WHERE specialization_id IS NULL; "
+        "UPDATE doctors SET specialization_id = "
+        "(SELECT specialization_id FROM specializations WHERE name = TRIM(doctors.specialization)) "
+        "WHERE specialization_id IS NULL;");
+    execute_sql(db, "CREATE INDEX IF NOT EXISTS idx_doctors_specialization_id ON doctors(specialization_id);");
 }
 
 // Execute SQL Queries
@@ -113,8 +244,7 @@ void execute_sql(sqlite3 *db, const char *sql) {
         fprintf(stderr, "SQL error: %s\n", err_msg);
         sqlite3_free(err_msg);
     }
-} 
-*/
+}
 
 // Main Menu
 void show_main_menu() {
@@ -143,6 +273,7 @@ void show_main_menu() {
             case 0:
                 printf("Exiting...\n");
                 wait_for_enter();
+                close_database();
                 exit(0);
             default:
                 printf("Invalid choice. Please try again.\n");
@@ -160,6 +291,8 @@ void admin_menu() {
         printf("\n=== ADMIN MENU ===\n\n");
         printf("1. View All System Data\n");
         printf("2. Generate Reports\n");
+        printf("3. Audit Log\n");
+        printf("4. Analytics Snapshot\n");
         printf("0. Logout\n");
         printf("\nEnter your choice: ");
         
@@ -169,6 +302,8 @@ void admin_menu() {
         switch (choice) {
             case 1 : view_system_data_menu(); break;
             case 2 : generate_reports_menu(); break;
+            case 3 : audit_menu(); break;
+            case 4 : snapshot_menu(); break;
             case 0 : return;
             default: 
                 printf("Invalid choice!\n"); 
@@ -233,6 +368,8 @@ void generate_reports_menu() {
         printf("1. Daily Doctor-wise Report\n");
         printf("2. Patient List by Doctor\n");
         printf("3. Appointment Trends\n");
+        printf("4. Appointment Trends Scaling Benchmark\n");
+        printf("5. Doctor Utilization Heatmap\n");
         printf("0. Back to Admin Menu\n");
         printf("\nEnter your choice: ");
         
@@ -243,6 +380,8 @@ void generate_reports_menu() {
             case 1 : generate_daily_report(); break;
             case 2 : generate_patient_list_by_doctor(); break;
             case 3 : generate_appointment_trends(); break;
+            case 4 : benchmark_appointment_trends(); break;
+            case 5 : generate_utilization_heatmap(); break;
             case 0 : return;
             default: 
                 printf("Invalid choice!\n"); 
@@ -252,18 +391,1377 @@ void generate_reports_menu() {
     }
 }
 
+// Reads a YYYY-MM-DD date; an empty answer means today
+void get_report_date(char *date, const char *message) {
+    while (1) {
+        printf("%s", message);
+        if (fgets(date, 32, stdin) == NULL) date[0] = 0;
+        date[strcspn(date, "\n")] = 0;
+
+        if (strlen(date) == 0) {
+            time_t now = time(NULL);
+            strftime(date, 11, "%Y-%m-%d", localtime(&now));
+            return;
+        }
+        int y, m, d;
+        if (strlen(date) == 10 && sscanf(date, "%4d-%2d-%2d", &y, &m, &d) == 3 &&
+            m >= 1 && m <= 12 && d >= 1 && d <= 31) {
+            return;
+        }
+        printf("Invalid date. Please use YYYY-MM-DD.\n");
+    }
+}
+
+// One row of the daily report, tagged with the branch it came from
+typedef struct {
+    int branch;
+    int doctor_id;
+    char doctor_name[MAX_STRING];
+    char specialization[MAX_STRING];
+    int appointments;
+} DailyReportRow;
+
+int compare_daily_rows(const void *a, const void *b) {
+    const DailyReportRow *x = a, *y = b;
+    if (x->appointments != y->appointments) return y->appointments - x->appointments;
+    return strcmp(x->doctor_name, y->doctor_name);
+}
+
+// Appointments per doctor on one day, across all branches, busiest first
 void generate_daily_report() {
-    printf("Generating daily doctor-wise report...\n");
+    char date[32];
+
+    clear_screen();
+    printf("=== DAILY DOCTOR-WISE REPORT ===\n");
+    get_report_date(date, "Report date (YYYY-MM-DD, Enter for today): ");
+
+    const char *sql =
+        "SELECT d.doctor_id, d.full_name, COALESCE(s.name, d.specialization), COUNT(a.appointment_id) "
+        "FROM doctors d "
+        "LEFT JOIN specializations s ON s.specialization_id = d.specialization_id "
+        "LEFT JOIN appointments a ON a.doctor_id = d.doctor_id AND a.appointment_date = ? "
+        "GROUP BY d.doctor_id;";
+
+    DailyReportRow *rows = NULL;
+    int row_count = 0, row_cap = 0;
+    int branch_totals[MAX_BRANCHES] = {0};
+
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(branches[b].db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement (%s): %s\n", branches[b].name, sqlite3_errmsg(branches[b].db));
+            continue;
+        }
+        sqlite3_bind_text(stmt, 1, date, -1, SQLITE_STATIC);
+
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            if (row_count == row_cap) {
+                row_cap = row_cap ? row_cap * 2 : 64;
+                rows = realloc(rows, row_cap * sizeof(DailyReportRow));
+            }
+            DailyReportRow *row = &rows[row_count++];
+            row->branch = b;
+            row->doctor_id = sqlite3_column_int(stmt, 0);
+            snprintf(row->doctor_name, sizeof(row->doctor_name), "%s", (const char *)sqlite3_column_text(stmt, 1));
+            snprintf(row->specialization, sizeof(row->specialization), "%s", (const char *)sqlite3_column_text(stmt, 2));
+            row->appointments = sqlite3_column_int(stmt, 3);
+            branch_totals[b] += row->appointments;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    qsort(rows, row_count, sizeof(DailyReportRow), compare_daily_rows);
+
+    printf("\nAppointments on %s\n", date);
+    printf("\n%-12s %-5s %-25s %-20s %-6s %-8s\n", "Branch", "ID", "Doctor Name", "Specialization", "Count", "Load");
+    printf("------------ ----- ------------------------- -------------------- ------ --------\n");
+    for (int i = 0; i < row_count; i++) {
+        printf("%-12s %-5d %-25s %-20s %-6d %5.1f%%\n",
+               branches[rows[i].branch].name, rows[i].doctor_id, rows[i].doctor_name,
+               rows[i].specialization, rows[i].appointments,
+               100.0 * rows[i].appointments / MAX_APPOINTMENTS_PER_DAY);
+    }
+
+    int total = 0;
+    printf("\n");
+    for (int b = 0; b < branch_count; b++) {
+        printf("%-12s total: %d\n", branches[b].name, branch_totals[b]);
+        total += branch_totals[b];
+    }
+    printf("All branches total: %d\n\n", total);
+
+    free(rows);
     wait_for_enter();
 }
 
+// Patients seen by every doctor whose name matches, across all branches
 void generate_patient_list_by_doctor() {
-    printf("Generating patient list by doctor...\n");
+    char name[MAX_STRING];
+
+    clear_screen();
+    printf("=== PATIENT LIST BY DOCTOR ===\n");
+    printf("Doctor name (or part of it, Enter for all): ");
+    if (fgets(name, sizeof(name), stdin) == NULL) name[0] = 0;
+    name[strcspn(name, "\n")] = 0;
+
+    const char *sql =
+        "SELECT d.doctor_id, d.full_name, p.patient_id, p.full_name, p.contact, "
+        "COUNT(*), MAX(a.appointment_date) "
+        "FROM appointments a "
+        "JOIN doctors d ON a.doctor_id = d.doctor_id "
+        "JOIN patients p ON a.patient_id = p.patient_id "
+        "WHERE d.full_name LIKE '%' || ? || '%' "
+        "GROUP BY d.doctor_id, p.patient_id "
+        "ORDER BY d.full_name, d.doctor_id, p.full_name;";
+
+    printf("\n%-12s %-25s %-5s %-25s %-12s %-7s %-12s\n", "Branch", "Doctor Name", "PID", "Patient Name", "Contact", "Visits", "Last Visit");
+    printf("------------ ------------------------- ----- ------------------------- ------------ ------- ------------\n");
+
+    int total = 0;
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(branches[b].db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement (%s): %s\n", branches[b].name, sqlite3_errmsg(branches[b].db));
+            continue;
+        }
+        sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            printf("%-12s %-25s %-5d %-25s %-12s %-7d %-12s\n",
+                   branches[b].name,
+                   (const char *)sqlite3_column_text(stmt, 1),
+                   sqlite3_column_int(stmt, 2),
+                   (const char *)sqlite3_column_text(stmt, 3),
+                   (const char *)sqlite3_column_text(stmt, 4),
+                   sqlite3_column_int(stmt, 5),
+                   (const char *)sqlite3_column_text(stmt, 6));
+            total++;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    printf("\n%d doctor/patient pairs.\n", total);
     wait_for_enter();
 }
 
+// Parallel Trend Engine
+//
+// The date span of every branch is cut into partitions that are scanned
+// concurrently through the appointment_date index. Each worker thread owns a
+// read-only connection per branch and a private partial aggregate, so workers
+// never share mutable state except the partition counter; the partials are
+// summed once all workers are done.
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+int days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void civil_from_days(int z, int *y, int *m, int *d) {
+    z += 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp + (mp < 10 ? 3 : -9);
+    *y = yoe + era * 400 + (*m <= 2);
+}
+
+int day_from_text(const char *date) {
+    int y, m, d;
+    if (date == NULL || sscanf(date, "%4d-%2d-%2d", &y, &m, &d) != 3) return 0;
+    return days_from_civil(y, m, d);
+}
+
+int available_cpus() {
+#ifdef _WIN32
+    const char *cpus = getenv("NUMBER_OF_PROCESSORS");
+    int n = cpus ? atoi(cpus) : 1;
+#else
+    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) n = 1;
+    return n > MAX_REPORT_THREADS ? MAX_REPORT_THREADS : n;
+}
+
+double monotonic_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef struct {
+    int first_month;    // year * 12 + (month - 1)
+    int month_count;
+    long long *months;
+    long long weekdays[7]; // 0 = Sunday
+    long long total;
+} TrendAggregate;
+
+typedef struct {
+    int branch;
+    int from_day, to_day; // Half-open day range [from_day, to_day)
+} TrendPartition;
+
+typedef struct {
+    TrendPartition *partitions;
+    int partition_count;
+    int next_partition;
+    pthread_mutex_t lock;
+    int first_month, month_count;
+} TrendJob;
+
+typedef struct {
+    TrendJob *job;
+    TrendAggregate partial;
+    int failed; // Partitions that could not be scanned
+} TrendWorker;
+
+void *trend_worker(void *arg) {
+    TrendWorker *worker = arg;
+    TrendJob *job = worker->job;
+    sqlite3 *connections[MAX_BRANCHES] = {0};
+    sqlite3_stmt *statements[MAX_BRANCHES] = {0};
+    int unavailable[MAX_BRANCHES] = {0}; // Open failed once; don't retry for every partition
+
+    while (1) {
+        pthread_mutex_lock(&job->lock);
+        int index = job->next_partition++;
+        pthread_mutex_unlock(&job->lock);
+        if (index >= job->partition_count) break;
+
+        TrendPartition *part = &job->partitions[index];
+        int b = part->branch;
+        if (unavailable[b]) {
+            worker->failed++;
+            continue;
+        }
+        if (connections[b] == NULL) {
+            if (sqlite3_open_v2(branches[b].db_path, &connections[b],
+                                SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK ||
+                sqlite3_prepare_v2(connections[b],
+                    "SELECT appointment_date, COUNT(*) FROM appointments "
+                    "WHERE appointment_date >= ? AND appointment_date < ? "
+                    "GROUP BY appointment_date;", -1, &statements[b], NULL) != SQLITE_OK) {
+                fprintf(stderr, "Trend worker error (%s): %s\n", branches[b].name, sqlite3_errmsg(connections[b]));
+                sqlite3_close(connections[b]); // sqlite3_open_v2 returns a handle even on failure
+                connections[b] = NULL;
+                unavailable[b] = 1;
+                worker->failed++;
+                continue;
+            }
+        }
+
+        char from[16], to[16];
+        int y, m, d;
+        civil_from_days(part->from_day, &y, &m, &d);
+        snprintf(from, sizeof(from), "%04d-%02d-%02d", y, m, d);
+        civil_from_days(part->to_day, &y, &m, &d);
+        snprintf(to, sizeof(to), "%04d-%02d-%02d", y, m, d);
+
+        sqlite3_stmt *stmt = statements[b];
+        sqlite3_bind_text(stmt, 1, from, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, to, -1, SQLITE_TRANSIENT);
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            int day = day_from_text((const char *)sqlite3_column_text(stmt, 0));
+            long long count = sqlite3_column_int64(stmt, 1);
+
+            civil_from_days(day, &y, &m, &d);
+            worker->partial.months[y * 12 + m - 1 - job->first_month] += count;
+            worker->partial.weekdays[((day % 7) + 11) % 7] += count; // 1970-01-01 was a Thursday
+            worker->partial.total += count;
+        }
+        if (rc != SQLITE_DONE) {
+            fprintf(stderr, "Trend worker error (%s): %s\n", branches[b].name, sqlite3_errmsg(connections[b]));
+            worker->failed++;
+        }
+        sqlite3_reset(stmt);
+    }
+
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_finalize(statements[b]);
+        sqlite3_close(connections[b]);
+    }
+    return NULL;
+}
+
+// Computes the trend aggregate over all branches with the given number of
+// worker threads. The caller frees result->months. Returns 0 on success, the
+// number of partitions that could not be scanned (the totals then miss them),
+// or -1 if the date range of a branch could not be read.
+int run_trend_report(int threads, TrendAggregate *result) {
+    int branch_first[MAX_BRANCHES], branch_last[MAX_BRANCHES];
+    int first_day = 0, last_day = -1;
+
+    memset(result, 0, sizeof(*result));
+
+    // MIN/MAX come straight off the ends of the date index
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_stmt *stmt;
+        branch_first[b] = 0;
+        branch_last[b] = -1;
+        if (sqlite3_prepare_v2(branches[b].db,
+                "SELECT MIN(appointment_date), MAX(appointment_date) FROM appointments;",
+                -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement (%s): %s\n", branches[b].name, sqlite3_errmsg(branches[b].db));
+            return -1;
+        }
+        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+            branch_first[b] = day_from_text((const char *)sqlite3_column_text(stmt, 0));
+            branch_last[b] = day_from_text((const char *)sqlite3_column_text(stmt, 1));
+            if (last_day < first_day || branch_first[b] < first_day) first_day = branch_first[b];
+            if (branch_last[b] > last_day) last_day = branch_last[b];
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (last_day < first_day) return 0; // No appointments anywhere
+
+    if (threads < 1) threads = 1;
+    if (threads > MAX_REPORT_THREADS) threads = MAX_REPORT_THREADS;
+
+    TrendJob job = {0};
+    int y, m, d;
+    civil_from_days(first_day, &y, &m, &d);
+    job.first_month = y * 12 + m - 1;
+    civil_from_days(last_day, &y, &m, &d);
+    job.month_count = y * 12 + m - job.first_month;
+    pthread_mutex_init(&job.lock, NULL);
+
+    int per_branch = threads * PARTITIONS_PER_THREAD;
+    job.partitions = malloc(sizeof(TrendPartition) * per_branch * branch_count);
+    for (int b = 0; b < branch_count; b++) {
+        if (branch_last[b] < branch_first[b]) continue;
+        int span = branch_last[b] - branch_first[b] + 1;
+        int parts = span < per_branch ? span : per_branch;
+        for (int p = 0; p < parts; p++) {
+            TrendPartition *part = &job.partitions[job.partition_count++];
+            part->branch = b;
+            part->from_day = branch_first[b] + (int)((long long)span * p / parts);
+            part->to_day = branch_first[b] + (int)((long long)span * (p + 1) / parts);
+        }
+    }
+
+    TrendWorker *workers = calloc(threads, sizeof(TrendWorker));
+    pthread_t *ids = malloc(sizeof(pthread_t) * threads);
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t].job = &job;
+        workers[t].partial.months = calloc(job.month_count, sizeof(long long));
+        if (pthread_create(&ids[t], NULL, trend_worker, &workers[t]) != 0) break;
+        started++;
+    }
+    if (started == 0) trend_worker(&workers[0]); // No threads available: scan inline
+
+    result->first_month = job.first_month;
+    result->month_count = job.month_count;
+    result->months = calloc(job.month_count, sizeof(long long));
+    int failed = 0;
+    for (int t = 0; t < threads; t++) {
+        if (t < started) pthread_join(ids[t], NULL);
+        for (int i = 0; i < job.month_count; i++) result->months[i] += workers[t].partial.months[i];
+        for (int i = 0; i < 7; i++) result->weekdays[i] += workers[t].partial.weekdays[i];
+        result->total += workers[t].partial.total;
+        failed += workers[t].failed;
+        free(workers[t].partial.months);
+    }
+
+    free(ids);
+    free(workers);
+    free(job.partitions);
+    pthread_mutex_destroy(&job.lock);
+    return failed;
+}
+
+// Monthly appointment counts summed over all branches
 void generate_appointment_trends() {
-    printf("Generating appointment trends...\n");
+    static const char *weekday_names[7] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    TrendAggregate trend;
+
+    clear_screen();
+    printf("=== APPOINTMENT TRENDS ===\n");
+
+    int threads = available_cpus();
+    double started = monotonic_seconds();
+    int failed = run_trend_report(threads, &trend);
+    double elapsed = monotonic_seconds() - started;
+
+    if (failed < 0) {
+        printf("\nThe branch databases could not be read.\n");
+        wait_for_enter();
+        return;
+    }
+    if (trend.total == 0 && failed == 0) {
+        printf("\nNo appointments recorded.\n");
+        free(trend.months);
+        wait_for_enter();
+        return;
+    }
+
+    long long peak = 1;
+    for (int m = 0; m < trend.month_count; m++) {
+        if (trend.months[m] > peak) peak = trend.months[m];
+    }
+
+    printf("\n%-8s %8s  %s\n", "Month", "Count", "Trend");
+    printf("-------- --------  ----------------------------------------\n");
+    for (int m = 0; m < trend.month_count; m++) {
+        int month = trend.first_month + m;
+        printf("%04d-%02d  %8lld  ", month / 12, month % 12 + 1, trend.months[m]);
+        for (long long i = 0; i < trend.months[m] * 40 / peak; i++) putchar('#');
+        putchar('\n');
+    }
+
+    printf("\nBy weekday:");
+    for (int w = 0; w < 7; w++) {
+        printf("  %s %lld", weekday_names[w], trend.weekdays[w]);
+    }
+    printf("\n\nTotal appointments across %d branch(es): %lld\n", branch_count, trend.total);
+    printf("Scanned with %d threads in %.3f s\n", threads, elapsed);
+    if (failed > 0) {
+        printf("INCOMPLETE: %d partition(s) could not be scanned; the counts above leave them out.\n", failed);
+    }
+
+    free(trend.months);
+    wait_for_enter();
+}
+
+// Runs the trend report with 1, 2, 4, ... threads up to twice the CPU count
+// and prints the best of three runs for each, with speedup over one thread.
+void benchmark_appointment_trends() {
+    clear_screen();
+    printf("=== APPOINTMENT TRENDS SCALING BENCHMARK ===\n");
+
+    int cpus = available_cpus();
+    int max_threads = cpus * 2 > MAX_REPORT_THREADS ? MAX_REPORT_THREADS : cpus * 2;
+    double baseline = 0;
+    long long total = 0;
+
+    printf("\n%d CPUs available, %d branch(es)\n\n", cpus, branch_count);
+    printf("%-8s %10s %9s %11s\n", "Threads", "Seconds", "Speedup", "Efficiency");
+    printf("-------- ---------- --------- -----------\n");
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double best = 0;
+        for (int run = 0; run < 3; run++) {
+            TrendAggregate trend;
+            double started = monotonic_seconds();
+            run_trend_report(threads, &trend);
+            double elapsed = monotonic_seconds() - started;
+            if (run == 0 || elapsed < best) best = elapsed;
+            total = trend.total;
+            free(trend.months);
+        }
+        if (threads == 1) baseline = best;
+        double speedup = best > 0 ? baseline / best : 0;
+        printf("%-8d %10.4f %8.2fx %10.0f%%\n", threads, best, speedup, 100.0 * speedup / threads);
+    }
+
+    printf("\n%lld appointments scanned per run.\n", total);
+    wait_for_enter();
+}
+
+// Doctor Utilization Heatmap
+//
+// Every appointment in the chosen weeks is binned into a dense
+// doctor x hour-of-week matrix (168 hours, Monday 00:00 first) in one pass
+// over the appointment_date index. A doctor's capacity for an hour is
+// MAX_APPOINTMENTS_PER_DAY spread evenly over clinic hours, times the number
+// of times that weekday occurs in the range; hours outside clinic hours have
+// no capacity. The matrix is shown as a terminal heatmap and written in full
+// to UTILIZATION_CSV.
+void generate_utilization_heatmap() {
+    static const char *day_names[7] = { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+    static const char shades[] = " .:-=+*#%@";
+    char to_date[32], from_date[11], weeks_text[16];
+
+    clear_screen();
+    printf("=== DOCTOR UTILIZATION HEATMAP ===\n");
+    get_report_date(to_date, "Last day (YYYY-MM-DD, Enter for today): ");
+    printf("Weeks to cover (Enter for %d): ", UTILIZATION_DEFAULT_WEEKS);
+    if (fgets(weeks_text, sizeof(weeks_text), stdin) == NULL) weeks_text[0] = 0;
+    int weeks = atoi(weeks_text) > 0 ? atoi(weeks_text) : UTILIZATION_DEFAULT_WEEKS;
+
+    int last_day = day_from_text(to_date);
+    int first_day = last_day - weeks * 7 + 1;
+    int y, m, d;
+    civil_from_days(first_day, &y, &m, &d);
+    snprintf(from_date, sizeof(from_date), "%04d-%02d-%02d", y, m, d);
+
+    // How often each weekday occurs in the range (1970-01-01 was a Thursday)
+    int weekday_occurrences[7] = {0};
+    for (int day = first_day; day <= last_day; day++) weekday_occurrences[(day % 7 + 10) % 7]++;
+    double hourly_capacity = (double)MAX_APPOINTMENTS_PER_DAY / (CLINIC_CLOSE_HOUR - CLINIC_OPEN_HOUR);
+
+    double started = monotonic_seconds();
+
+    // One matrix row per doctor of every branch
+    UtilizationRow *rows = NULL;
+    int row_count = 0, row_cap = 0;
+    int *row_of_doctor[MAX_BRANCHES] = {0};
+    int doctor_limit[MAX_BRANCHES] = {0};
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(branches[b].db, "SELECT COALESCE(MAX(doctor_id), 0) FROM doctors;", -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement (%s): %s\n", branches[b].name, sqlite3_errmsg(branches[b].db));
+            continue;
+        }
+        if (sqlite3_step(stmt) == SQLITE_ROW) doctor_limit[b] = sqlite3_column_int(stmt, 0) + 1;
+        sqlite3_finalize(stmt);
+        row_of_doctor[b] = malloc(doctor_limit[b] * sizeof(int));
+        if (!row_of_doctor[b]) continue;
+        for (int i = 0; i < doctor_limit[b]; i++) row_of_doctor[b][i] = -1;
+
+        if (sqlite3_prepare_v2(branches[b].db, "SELECT doctor_id, full_name FROM doctors ORDER BY doctor_id;", -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement (%s): %s\n", branches[b].name, sqlite3_errmsg(branches[b].db));
+            continue;
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int doctor_id = sqlite3_column_int(stmt, 0);
+            if (doctor_id < 0 || doctor_id >= doctor_limit[b]) continue;
+            if (row_count == row_cap) {
+                row_cap = row_cap ? row_cap * 2 : 64;
+                UtilizationRow *grown = realloc(rows, row_cap * sizeof(UtilizationRow));
+                if (!grown) break;
+                rows = grown;
+            }
+            UtilizationRow *row = &rows[row_count];
+            memset(row, 0, sizeof(*row));
+            row->branch = b;
+            row->doctor_id = doctor_id;
+            snprintf(row->doctor_name, sizeof(row->doctor_name), "%s", (const char *)sqlite3_column_text(stmt, 1));
+            row_of_doctor[b][doctor_id] = row_count++;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    // Single pass over the appointments in range
+    long long binned = 0;
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_stmt *stmt;
+        if (row_of_doctor[b] == NULL) continue;
+        if (sqlite3_prepare_v2(branches[b].db,
+                "SELECT doctor_id, appointment_date, appointment_time FROM appointments "
+                "WHERE appointment_date BETWEEN ? AND ?;", -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement (%s): %s\n", branches[b].name, sqlite3_errmsg(branches[b].db));
+            continue;
+        }
+        sqlite3_bind_text(stmt, 1, from_date, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, to_date, -1, SQLITE_STATIC);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int doctor_id = sqlite3_column_int(stmt, 0);
+            const char *time_text = (const char *)sqlite3_column_text(stmt, 2);
+            if (doctor_id < 0 || doctor_id >= doctor_limit[b] || row_of_doctor[b][doctor_id] < 0 || time_text == NULL) continue;
+            int day = day_from_text((const char *)sqlite3_column_text(stmt, 1));
+            int hour = (time_text[0] - '0') * 10 + (time_text[1] - '0');
+            if (hour < 0 || hour > 23) continue;
+            rows[row_of_doctor[b][doctor_id]].counts[((day % 7 + 10) % 7) * 24 + hour]++;
+            binned++;
+        }
+        sqlite3_finalize(stmt);
+    }
+    double elapsed = monotonic_seconds() - started;
+
+    // Hours shown: clinic hours, widened to any hour that has appointments
+    int first_hour = CLINIC_OPEN_HOUR, last_hour = CLINIC_CLOSE_HOUR - 1;
+    for (int r = 0; r < row_count; r++) {
+        for (int h = 0; h < 168; h++) {
+            if (rows[r].counts[h] == 0) continue;
+            if (h % 24 < first_hour) first_hour = h % 24;
+            if (h % 24 > last_hour) last_hour = h % 24;
+        }
+    }
+
+    printf("\n%s to %s (%d week%s), %lld appointments\n", from_date, to_date, weeks, weeks == 1 ? "" : "s", binned);
+    printf("Scale: '%s' = 0-100%% of capacity in 10%% steps, '!' = over capacity or outside clinic hours\n", shades);
+
+    FILE *csv = fopen(UTILIZATION_CSV, "w");
+    if (csv == NULL) {
+        fprintf(stderr, "Cannot write %s\n", UTILIZATION_CSV);
+    } else {
+        fprintf(csv, "branch,doctor_id,doctor_name,weekday,hour,appointments,capacity,utilization\n");
+    }
+
+    for (int r = 0; r < row_count; r++) {
+        UtilizationRow *row = &rows[r];
+        long long booked = 0;
+        double capacity_total = 0;
+        for (int h = 0; h < 168; h++) {
+            int hour = h % 24;
+            double capacity = (hour >= CLINIC_OPEN_HOUR && hour < CLINIC_CLOSE_HOUR)
+                            ? hourly_capacity * weekday_occurrences[h / 24] : 0;
+            booked += row->counts[h];
+            capacity_total += capacity;
+            if (csv != NULL) {
+                fprintf(csv, "%s,%d,\"", branches[row->branch].name, row->doctor_id);
+                for (const char *c = row->doctor_name; *c; c++) {
+                    if (*c == '"') fputc('"', csv);
+                    fputc(*c, csv);
+                }
+                fprintf(csv, "\",%s,%d,%d,%.2f,", day_names[h / 24], hour, row->counts[h], capacity);
+                if (capacity > 0) fprintf(csv, "%.4f", row->counts[h] / capacity);
+                fputc('\n', csv);
+            }
+        }
+
+        printf("\n%s / %d %s - %.1f%% utilized\n     ", branches[row->branch].name, row->doctor_id, row->doctor_name,
+               capacity_total > 0 ? 100.0 * booked / capacity_total : 0.0);
+        for (int hour = first_hour; hour <= last_hour; hour++) printf(" %02d", hour);
+        printf("\n");
+        for (int wd = 0; wd < 7; wd++) {
+            printf("%s  ", day_names[wd]);
+            for (int hour = first_hour; hour <= last_hour; hour++) {
+                int count = row->counts[wd * 24 + hour];
+                double capacity = (hour >= CLINIC_OPEN_HOUR && hour < CLINIC_CLOSE_HOUR)
+                                ? hourly_capacity * weekday_occurrences[wd] : 0;
+                char shade;
+                if (count > 0 && count > capacity) shade = '!';
+                else if (count == 0) shade = shades[0];
+                else shade = shades[1 + (int)(8.999 * count / capacity)];
+                printf(" %c%c", shade, shade);
+            }
+            printf("\n");
+        }
+    }
+
+    if (csv != NULL) {
+        fclose(csv);
+        printf("\nFull matrix written to %s.\n", UTILIZATION_CSV);
+    }
+    printf("Binned in %.3f s.\n\n", elapsed);
+
+    for (int b = 0; b < branch_count; b++) free(row_of_doctor[b]);
+    free(rows);
+    wait_for_enter();
+}
+
+// Analytics Snapshot
+//
+// A snapshot is a columnar binary copy of doctors, patients and appointments
+// of all branches, for analysis without touching the live databases:
+//
+//     SnapshotHeader | column 0 | column 1 | ... | string dictionary
+//
+// Every column is a packed array of fixed-width little-endian values starting
+// at an 8-byte aligned offset recorded in the header. Dates are day numbers
+// (days since 1970-01-01), times are minutes after midnight, and doctor names,
+// specializations and branch names are codes into the string dictionary
+// (uint32 count, uint32 offsets[count + 1], then the string bytes).
+// Appointments reference doctors by row number in the doctor columns.
+enum {
+    COL_DOCTOR_ID, COL_DOCTOR_BRANCH, COL_DOCTOR_NAME, COL_DOCTOR_SPECIALIZATION,
+    COL_PATIENT_ID, COL_PATIENT_BRANCH, COL_PATIENT_AGE, COL_PATIENT_WEIGHT, COL_PATIENT_GENDER,
+    COL_APPOINTMENT_ID, COL_APPOINTMENT_BRANCH, COL_APPOINTMENT_PATIENT, COL_APPOINTMENT_DOCTOR,
+    COL_APPOINTMENT_DAY, COL_APPOINTMENT_MINUTE,
+    SNAPSHOT_COLUMNS
+};
+
+// Value width in bytes of every column, in enum order
+static const int snapshot_column_width[SNAPSHOT_COLUMNS] = {
+    4, 1, 4, 4,    // doctor: int32 id, uint8 branch, uint32 name code, uint32 specialization code
+    4, 1, 2, 4, 1, // patient: int32 id, uint8 branch, uint16 age, float weight, char gender
+    4, 1, 4, 4,    // appointment: int32 id, uint8 branch, int32 patient id, uint32 doctor row
+    4, 2           //              int32 day number, uint16 minute of day
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t byte_order; // 0x01020304 as stored by the exporting machine
+    uint32_t branch_count;
+    int64_t created_at;
+    uint64_t doctor_rows, patient_rows, appointment_rows;
+    uint64_t dictionary_offset, dictionary_size;
+    uint32_t branch_name_codes[MAX_BRANCHES];
+    uint64_t column_offsets[SNAPSHOT_COLUMNS];
+} SnapshotHeader;
+
+// Buffers one column and writes it out a chunk at a time at its own offset
+typedef struct {
+    FILE *file;
+    uint64_t offset;
+    int width;
+    uint64_t rows_written;
+    int buffered;
+    unsigned char chunk[SNAPSHOT_CHUNK_ROWS * 4];
+} ColumnWriter;
+
+void column_flush(ColumnWriter *column) {
+    if (column->buffered == 0) return;
+    fseek64(column->file, column->offset + column->rows_written * column->width, SEEK_SET);
+    fwrite(column->chunk, column->width, column->buffered, column->file);
+    column->rows_written += column->buffered;
+    column->buffered = 0;
+}
+
+void column_put(ColumnWriter *column, const void *value) {
+    memcpy(column->chunk + column->buffered * column->width, value, column->width);
+    if (++column->buffered == SNAPSHOT_CHUNK_ROWS) column_flush(column);
+}
+
+// String dictionary: open-addressing hash from string to code
+typedef struct {
+    char *bytes;
+    uint32_t bytes_len, bytes_cap;
+    uint32_t *offsets; // offsets[code] = start of string code in bytes
+    uint32_t count, offsets_cap;
+    uint32_t *slots;   // code + 1, 0 = empty
+    uint32_t slot_count;
+} StringDictionary;
+
+uint32_t hash_string(const char *text) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    while (*text) {
+        hash ^= (unsigned char)*text++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t dictionary_code(StringDictionary *dict, const char *text) {
+    if (text == NULL) text = "";
+    if ((dict->count + 1) * 2 > dict->slot_count) {
+        uint32_t slot_count = dict->slot_count ? dict->slot_count * 2 : 256;
+        uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+        for (uint32_t code = 0; code < dict->count; code++) {
+            uint32_t i = hash_string(dict->bytes + dict->offsets[code]) & (slot_count - 1);
+            while (slots[i]) i = (i + 1) & (slot_count - 1);
+            slots[i] = code + 1;
+        }
+        free(dict->slots);
+        dict->slots = slots;
+        dict->slot_count = slot_count;
+    }
+
+    uint32_t i = hash_string(text) & (dict->slot_count - 1);
+    while (dict->slots[i]) {
+        uint32_t code = dict->slots[i] - 1;
+        if (strcmp(dict->bytes + dict->offsets[code], text) == 0) return code;
+        i = (i + 1) & (dict->slot_count - 1);
+    }
+
+    uint32_t len = (uint32_t)strlen(text) + 1;
+    if (dict->bytes_len + len > dict->bytes_cap) {
+        dict->bytes_cap = (dict->bytes_len + len) * 2;
+        dict->bytes = realloc(dict->bytes, dict->bytes_cap);
+    }
+    if (dict->count + 1 >= dict->offsets_cap) {
+        dict->offsets_cap = dict->offsets_cap ? dict->offsets_cap * 2 : 256;
+        dict->offsets = realloc(dict->offsets, dict->offsets_cap * sizeof(uint32_t));
+    }
+    memcpy(dict->bytes + dict->bytes_len, text, len);
+    dict->offsets[dict->count] = dict->bytes_len;
+    dict->bytes_len += len;
+    dict->slots[i] = dict->count + 1;
+    return dict->count++;
+}
+
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+long long count_rows(sqlite3 *db, const char *sql) {
+    sqlite3_stmt *stmt;
+    long long count = 0;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) count = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+    return count;
+}
+
+// Writes the snapshot in one streaming pass per table. Row counts are taken
+// first inside a read transaction on every branch, so every column's offset
+// is known up front and each column is written in fixed-size chunks. Memory
+// use is bounded by the chunk buffers plus the dictionary and doctor map,
+// both of which grow with the number of doctors, not appointments.
+void export_snapshot() {
+    char path[MAX_STRING];
+
+    clear_screen();
+    printf("=== EXPORT ANALYTICS SNAPSHOT ===\n");
+    printf("Snapshot file (Enter for %s): ", SNAPSHOT_FILE);
+    if (fgets(path, sizeof(path), stdin) == NULL) path[0] = 0;
+    path[strcspn(path, "\n")] = 0;
+    if (strlen(path) == 0) strcpy(path, SNAPSHOT_FILE);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Cannot create %s.\n", path);
+        wait_for_enter();
+        return;
+    }
+
+    double started = monotonic_seconds();
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.byte_order = 0x01020304;
+    header.branch_count = branch_count;
+    header.created_at = (int64_t)time(NULL);
+
+    StringDictionary dict = {0};
+    long long doctor_max_id[MAX_BRANCHES] = {0};
+    for (int b = 0; b < branch_count; b++) {
+        execute_sql(branches[b].db, "BEGIN;");
+        header.doctor_rows += count_rows(branches[b].db, "SELECT COUNT(*) FROM doctors;");
+        header.patient_rows += count_rows(branches[b].db, "SELECT COUNT(*) FROM patients;");
+        header.appointment_rows += count_rows(branches[b].db, "SELECT COUNT(*) FROM appointments;");
+        doctor_max_id[b] = count_rows(branches[b].db, "SELECT COALESCE(MAX(doctor_id), 0) FROM doctors;");
+        header.branch_name_codes[b] = dictionary_code(&dict, branches[b].name);
+    }
+
+    uint64_t offset = align8(sizeof(SnapshotHeader));
+    for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        uint64_t rows = c <= COL_DOCTOR_SPECIALIZATION ? header.doctor_rows
+                      : c <= COL_PATIENT_GENDER ? header.patient_rows
+                      : header.appointment_rows;
+        header.column_offsets[c] = offset;
+        offset = align8(offset + rows * snapshot_column_width[c]);
+    }
+
+    ColumnWriter *columns = calloc(SNAPSHOT_COLUMNS, sizeof(ColumnWriter));
+    for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        columns[c].file = file;
+        columns[c].offset = header.column_offsets[c];
+        columns[c].width = snapshot_column_width[c];
+    }
+
+    // Doctors; remember each doctor's row so appointments can point at it
+    uint32_t doctor_row = 0;
+    uint32_t *doctor_refs[MAX_BRANCHES] = {0};
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_stmt *stmt;
+        doctor_refs[b] = malloc((doctor_max_id[b] + 1) * sizeof(uint32_t));
+        memset(doctor_refs[b], 0xFF, (doctor_max_id[b] + 1) * sizeof(uint32_t)); // Unknown doctor
+        if (sqlite3_prepare_v2(branches[b].db, "SELECT d.doctor_id, d.full_name, COALESCE(s.name, d.specialization) FROM doctors d "
+                                                 "LEFT JOIN specializations s ON s.specialization_id = d.specialization_id;", -1, &stmt, NULL) != SQLITE_OK) continue;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int32_t id = sqlite3_column_int(stmt, 0);
+            uint8_t branch = (uint8_t)b;
+            uint32_t name = dictionary_code(&dict, (const char *)sqlite3_column_text(stmt, 1));
+            uint32_t specialization = dictionary_code(&dict, (const char *)sqlite3_column_text(stmt, 2));
+            column_put(&columns[COL_DOCTOR_ID], &id);
+            column_put(&columns[COL_DOCTOR_BRANCH], &branch);
+            column_put(&columns[COL_DOCTOR_NAME], &name);
+            column_put(&columns[COL_DOCTOR_SPECIALIZATION], &specialization);
+            if (id >= 0 && id <= doctor_max_id[b]) doctor_refs[b][id] = doctor_row;
+            doctor_row++;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(branches[b].db, "SELECT patient_id, age, weight, gender FROM patients;", -1, &stmt, NULL) != SQLITE_OK) continue;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int32_t id = sqlite3_column_int(stmt, 0);
+            uint8_t branch = (uint8_t)b;
+            uint16_t age = (uint16_t)sqlite3_column_int(stmt, 1);
+            float weight = (float)sqlite3_column_double(stmt, 2);
+            const char *gender_text = (const char *)sqlite3_column_text(stmt, 3);
+            char gender = gender_text ? gender_text[0] : 'O';
+            column_put(&columns[COL_PATIENT_ID], &id);
+            column_put(&columns[COL_PATIENT_BRANCH], &branch);
+            column_put(&columns[COL_PATIENT_AGE], &age);
+            column_put(&columns[COL_PATIENT_WEIGHT], &weight);
+            column_put(&columns[COL_PATIENT_GENDER], &gender);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(branches[b].db,
+                "SELECT appointment_id, patient_id, doctor_id, appointment_date, appointment_time FROM appointments;",
+                -1, &stmt, NULL) != SQLITE_OK) continue;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int32_t id = sqlite3_column_int(stmt, 0);
+            uint8_t branch = (uint8_t)b;
+            int32_t patient = sqlite3_column_int(stmt, 1);
+            int doctor_id = sqlite3_column_int(stmt, 2);
+            uint32_t doctor = doctor_id >= 0 && doctor_id <= doctor_max_id[b] ? doctor_refs[b][doctor_id] : UINT32_MAX;
+            int32_t day = day_from_text((const char *)sqlite3_column_text(stmt, 3));
+            int hour = 0, minute = 0;
+            const char *time_text = (const char *)sqlite3_column_text(stmt, 4);
+            if (time_text) sscanf(time_text, "%d:%d", &hour, &minute);
+            uint16_t minute_of_day = (uint16_t)(hour * 60 + minute);
+            column_put(&columns[COL_APPOINTMENT_ID], &id);
+            column_put(&columns[COL_APPOINTMENT_BRANCH], &branch);
+            column_put(&columns[COL_APPOINTMENT_PATIENT], &patient);
+            column_put(&columns[COL_APPOINTMENT_DOCTOR], &doctor);
+            column_put(&columns[COL_APPOINTMENT_DAY], &day);
+            column_put(&columns[COL_APPOINTMENT_MINUTE], &minute_of_day);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    for (int b = 0; b < branch_count; b++) {
+        execute_sql(branches[b].db, "COMMIT;");
+        free(doctor_refs[b]);
+    }
+    for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        column_flush(&columns[c]);
+    }
+    free(columns);
+
+    // Dictionary goes after the last column, then the header is filled in
+    dict.offsets[dict.count] = dict.bytes_len;
+    header.dictionary_offset = offset;
+    header.dictionary_size = sizeof(uint32_t) * (dict.count + 2) + dict.bytes_len;
+    fseek64(file, offset, SEEK_SET);
+    fwrite(&dict.count, sizeof(uint32_t), 1, file);
+    fwrite(dict.offsets, sizeof(uint32_t), dict.count + 1, file);
+    fwrite(dict.bytes, 1, dict.bytes_len, file);
+    fseek64(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+    int failed = ferror(file);
+    fclose(file);
+    free(dict.bytes);
+    free(dict.offsets);
+    free(dict.slots);
+
+    if (failed) {
+        printf("\nWriting %s failed.\n", path);
+    } else {
+        printf("\nSnapshot written to %s in %.2f s\n", path, monotonic_seconds() - started);
+        printf("%llu doctors, %llu patients, %llu appointments, %u dictionary strings, %.1f MB\n",
+               (unsigned long long)header.doctor_rows, (unsigned long long)header.patient_rows,
+               (unsigned long long)header.appointment_rows, dict.count,
+               (header.dictionary_offset + header.dictionary_size) / 1048576.0);
+    }
+    wait_for_enter();
+}
+
+typedef struct {
+    const unsigned char *base;
+    size_t size;
+    const SnapshotHeader *header;
+    const uint32_t *dictionary_offsets;
+    const char *dictionary_bytes;
+} Snapshot;
+
+void snapshot_close(Snapshot *snapshot) {
+    if (snapshot->base == NULL) return;
+#ifdef _WIN32
+    free((void *)snapshot->base);
+#else
+    munmap((void *)snapshot->base, snapshot->size);
+#endif
+    snapshot->base = NULL;
+}
+
+// Maps the snapshot read-only (reads it into memory on Windows) and checks
+// that every column lies inside the file. Returns 0 on success.
+int snapshot_open(const char *path, Snapshot *snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+#ifdef _WIN32
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return 1;
+    _fseeki64(file, 0, SEEK_END);
+    snapshot->size = (size_t)_ftelli64(file);
+    _fseeki64(file, 0, SEEK_SET);
+    unsigned char *data = malloc(snapshot->size ? snapshot->size : 1);
+    if (fread(data, 1, snapshot->size, file) != snapshot->size) snapshot->size = 0;
+    fclose(file);
+    snapshot->base = data;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SnapshotHeader)) {
+        close(fd);
+        return 1;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return 1;
+    snapshot->base = data;
+    snapshot->size = (size_t)st.st_size;
+#endif
+
+    const SnapshotHeader *header = (const SnapshotHeader *)snapshot->base;
+    snapshot->header = header;
+    int valid = snapshot->size >= sizeof(SnapshotHeader) &&
+                memcmp(header->magic, SNAPSHOT_MAGIC, 8) == 0 &&
+                header->byte_order == 0x01020304 &&
+                header->branch_count <= MAX_BRANCHES &&
+                header->dictionary_offset + header->dictionary_size <= snapshot->size;
+    for (int c = 0; valid && c < SNAPSHOT_COLUMNS; c++) {
+        uint64_t rows = c <= COL_DOCTOR_SPECIALIZATION ? header->doctor_rows
+                      : c <= COL_PATIENT_GENDER ? header->patient_rows
+                      : header->appointment_rows;
+        valid = header->column_offsets[c] + rows * snapshot_column_width[c] <= snapshot->size;
+    }
+    if (valid) {
+        const uint32_t *dictionary = (const uint32_t *)(snapshot->base + header->dictionary_offset);
+        snapshot->dictionary_offsets = dictionary + 1;
+        snapshot->dictionary_bytes = (const char *)(dictionary + dictionary[0] + 2);
+    }
+    if (!valid) {
+        snapshot_close(snapshot);
+        return 2;
+    }
+    return 0;
+}
+
+const void *snapshot_column(const Snapshot *snapshot, int column) {
+    return snapshot->base + snapshot->header->column_offsets[column];
+}
+
+const char *snapshot_string(const Snapshot *snapshot, uint32_t code) {
+    return snapshot->dictionary_bytes + snapshot->dictionary_offsets[code];
+}
+
+// Monthly trend and per-doctor utilization computed straight off the mapped
+// columns. Utilization is appointments over the capacity of the days the
+// doctor had any booking (MAX_APPOINTMENTS_PER_DAY each).
+void analyze_snapshot() {
+    char path[MAX_STRING];
+    Snapshot snapshot;
+
+    clear_screen();
+    printf("=== ANALYZE SNAPSHOT ===\n");
+    printf("Snapshot file (Enter for %s): ", SNAPSHOT_FILE);
+    if (fgets(path, sizeof(path), stdin) == NULL) path[0] = 0;
+    path[strcspn(path, "\n")] = 0;
+    if (strlen(path) == 0) strcpy(path, SNAPSHOT_FILE);
+
+    int rc = snapshot_open(path, &snapshot);
+    if (rc != 0) {
+        printf(rc == 1 ? "Cannot open %s.\n" : "%s is not a valid snapshot.\n", path);
+        wait_for_enter();
+        return;
+    }
+
+    const SnapshotHeader *header = snapshot.header;
+    uint64_t appointments = header->appointment_rows;
+    uint64_t doctors = header->doctor_rows;
+    const int32_t *days = snapshot_column(&snapshot, COL_APPOINTMENT_DAY);
+    const uint32_t *doctor_of = snapshot_column(&snapshot, COL_APPOINTMENT_DOCTOR);
+
+    time_t created = (time_t)header->created_at;
+    char created_text[32];
+    strftime(created_text, sizeof(created_text), "%Y-%m-%d %H:%M", localtime(&created));
+    printf("\nSnapshot of %u branch(es) taken %s: %llu appointments, %llu doctors, %llu patients\n",
+           header->branch_count, created_text, (unsigned long long)appointments,
+           (unsigned long long)doctors, (unsigned long long)header->patient_rows);
+    if (appointments == 0) {
+        snapshot_close(&snapshot);
+        wait_for_enter();
+        return;
+    }
+
+    int first_day = days[0], last_day = days[0];
+    for (uint64_t i = 1; i < appointments; i++) {
+        if (days[i] < first_day) first_day = days[i];
+        if (days[i] > last_day) last_day = days[i];
+    }
+    int y, m, d;
+    civil_from_days(first_day, &y, &m, &d);
+    int first_month = y * 12 + m - 1;
+    civil_from_days(last_day, &y, &m, &d);
+    int month_count = y * 12 + m - first_month;
+
+    // Day number -> month index lookup keeps the hot loop free of date math
+    int span = last_day - first_day + 1;
+    uint16_t *month_of_day = malloc(sizeof(uint16_t) * span);
+    for (int day = 0; day < span; day++) {
+        civil_from_days(first_day + day, &y, &m, &d);
+        month_of_day[day] = (uint16_t)(y * 12 + m - 1 - first_month);
+    }
+
+    long long *months = calloc(month_count, sizeof(long long));
+    long long *per_doctor = calloc(doctors + 1, sizeof(long long));
+    uint64_t day_words = ((uint64_t)span + 63) / 64;
+    uint64_t *booked_days = calloc((doctors + 1) * day_words, sizeof(uint64_t));
+    for (uint64_t i = 0; i < appointments; i++) {
+        int day = days[i] - first_day;
+        uint32_t doctor = doctor_of[i] < doctors ? doctor_of[i] : (uint32_t)doctors;
+        months[month_of_day[day]]++;
+        per_doctor[doctor]++;
+        booked_days[doctor * day_words + day / 64] |= (uint64_t)1 << (day % 64);
+    }
+
+    long long peak = 1;
+    for (int i = 0; i < month_count; i++) {
+        if (months[i] > peak) peak = months[i];
+    }
+    printf("\n%-8s %8s  %s\n", "Month", "Count", "Trend");
+    printf("-------- --------  ----------------------------------------\n");
+    for (int i = 0; i < month_count; i++) {
+        printf("%04d-%02d  %8lld  ", (first_month + i) / 12, (first_month + i) % 12 + 1, months[i]);
+        for (long long j = 0; j < months[i] * 40 / peak; j++) putchar('#');
+        putchar('\n');
+    }
+
+    const uint8_t *doctor_branch = snapshot_column(&snapshot, COL_DOCTOR_BRANCH);
+    const uint32_t *doctor_name = snapshot_column(&snapshot, COL_DOCTOR_NAME);
+    const uint32_t *doctor_specialization = snapshot_column(&snapshot, COL_DOCTOR_SPECIALIZATION);
+    printf("\n%-12s %-25s %-20s %8s %6s %7s %7s\n", "Branch", "Doctor Name", "Specialization", "Appts", "Days", "Per Day", "Util");
+    printf("------------ ------------------------- -------------------- -------- ------ ------- -------\n");
+    for (uint64_t doc = 0; doc < doctors; doc++) {
+        long long worked = 0;
+        for (uint64_t w = 0; w < day_words; w++) {
+            worked += __builtin_popcountll(booked_days[doc * day_words + w]);
+        }
+        double per_day = worked ? (double)per_doctor[doc] / worked : 0;
+        printf("%-12s %-25s %-20s %8lld %6lld %7.1f %6.1f%%\n",
+               snapshot_string(&snapshot, header->branch_name_codes[doctor_branch[doc]]),
+               snapshot_string(&snapshot, doctor_name[doc]),
+               snapshot_string(&snapshot, doctor_specialization[doc]),
+               per_doctor[doc], worked, per_day, 100.0 * per_day / MAX_APPOINTMENTS_PER_DAY);
+    }
+
+    free(month_of_day);
+    free(months);
+    free(per_doctor);
+    free(booked_days);
+    snapshot_close(&snapshot);
+    wait_for_enter();
+}
+
+// Analytics Snapshot Menu
+void snapshot_menu() {
+    int choice;
+
+    while (1) {
+        clear_screen();
+        printf("\n=== ANALYTICS SNAPSHOT ===\n\n");
+        printf("1. Export Columnar Snapshot\n");
+        printf("2. Analyze Snapshot (Trends and Utilization)\n");
+        printf("0. Back to Admin Menu\n");
+        printf("\nEnter your choice: ");
+
+        scanf("%d", &choice);
+        clear_input_buffer();
+
+        switch (choice) {
+            case 1 : export_snapshot(); break;
+            case 2 : analyze_snapshot(); break;
+            case 0 : return;
+            default:
+                printf("Invalid choice!\n");
+                wait_for_enter();
+                break;
+        }
+    }
+}
+
+// Audit Menu
+void audit_menu() {
+    int choice;
+
+    while (1) {
+        clear_screen();
+        printf("\n=== AUDIT LOG ===\n\n");
+        printf("1. Load Audit Journal\n");
+        printf("2. Query Audit Log\n");
+        printf("0. Back to Admin Menu\n");
+        printf("\nEnter your choice: ");
+
+        scanf("%d", &choice);
+        clear_input_buffer();
+
+        switch (choice) {
+            case 1 : load_audit_journal(); break;
+            case 2 : query_audit_log(); break;
+            case 0 : return;
+            default:
+                printf("Invalid choice!\n");
+                wait_for_enter();
+                break;
+        }
+    }
+}
+
+// Loads the journals of all branches into their audit_log tables
+void load_audit_journal() {
+    clear_screen();
+    printf("=== LOAD AUDIT JOURNAL ===\n\n");
+
+    for (int b = 0; b < branch_count; b++) {
+        int skipped = 0;
+        int loaded = load_branch_journal(&branches[b], &skipped);
+        if (loaded >= 0) {
+            printf("%-12s %d audit records loaded (%d malformed lines skipped).\n", branches[b].name, loaded, skipped);
+        }
+    }
+
+    printf("\n");
+    wait_for_enter();
+}
+
+// Loads journal lines written since the last load into the branch's audit_log,
+// in one transaction. Only complete lines are consumed, so a record that is
+// still being appended is picked up by the next load. Returns -1 on error.
+int load_branch_journal(Branch *branch, int *skipped) {
+    sqlite3 *db = branch->db;
+    long loaded_offset = 0;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT loaded_offset FROM audit_journal_state WHERE journal = ?;", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, branch->journal_path, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) loaded_offset = (long)sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+
+    FILE *journal = fopen(branch->journal_path, "rb");
+    if (journal == NULL) {
+        printf("%-12s no audit journal found (%s).\n", branch->name, branch->journal_path);
+        return -1;
+    }
+    fseek(journal, 0, SEEK_END);
+    if (ftell(journal) < loaded_offset) {
+        printf("%-12s journal is shorter than the loaded offset; it was replaced. Reloading from the start.\n", branch->name);
+        loaded_offset = 0;
+    }
+    fseek(journal, loaded_offset, SEEK_SET);
+
+    if (sqlite3_prepare_v2(db,
+            "INSERT INTO audit_log (logged_at, operator, action, table_name, record_id) "
+            "VALUES (?, ?, ?, ?, ?);", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        fclose(journal);
+        return -1;
+    }
+
+    execute_sql(db, "BEGIN;");
+    char line[512];
+    int loaded = 0;
+    while (fgets(line, sizeof(line), journal) != NULL) {
+        size_t len = strlen(line);
+        if (len == 0 || line[len - 1] != '\n') break; // Partial trailing record
+        line[len - 1] = '\0';
+
+        char *fields[5];
+        int n = 0;
+        for (char *field = strtok(line, "\t"); field != NULL && n < 5; field = strtok(NULL, "\t")) {
+            fields[n++] = field;
+        }
+        loaded_offset += (long)len;
+        if (n != 5) {
+            (*skipped)++;
+            continue;
+        }
+
+        sqlite3_bind_int64(stmt, 1, atoll(fields[0]));
+        sqlite3_bind_text(stmt, 2, fields[1], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, fields[2], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, fields[3], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 5, atoll(fields[4]));
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            loaded++;
+        } else {
+            (*skipped)++;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    fclose(journal);
+
+    if (sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO audit_journal_state (journal, loaded_offset) VALUES (?, ?);", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, branch->journal_path, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 2, loaded_offset);
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+    execute_sql(db, "COMMIT;");
+
+    return loaded;
+}
+
+// One audit entry, tagged with the branch it came from
+typedef struct {
+    int branch;
+    long long logged_at;
+    char operator_name[64];
+    char action[8];
+    char table_name[32];
+    long long record_id;
+} AuditEntry;
+
+int compare_audit_entries(const void *a, const void *b) {
+    const AuditEntry *x = a, *y = b;
+    return (x->logged_at < y->logged_at) - (x->logged_at > y->logged_at); // Newest first
+}
+
+// Shows the most recent audit entries for a record, an operator, or both.
+// Only the filters actually given are added to the query so the matching
+// index is used. Every branch returns its newest entries, which are merged.
+void query_audit_log() {
+    char table[64], operator_name[64], record[32];
+
+    clear_screen();
+    printf("=== QUERY AUDIT LOG ===\n");
+    printf("Leave a filter blank to ignore it.\n\n");
+
+    printf("Table (patients/doctors/appointments/waitlist): ");
+    fgets(table, sizeof(table), stdin);
+    table[strcspn(table, "\n")] = 0;
+    printf("Record ID: ");
+    fgets(record, sizeof(record), stdin);
+    record[strcspn(record, "\n")] = 0;
+    printf("Operator: ");
+    fgets(operator_name, sizeof(operator_name), stdin);
+    operator_name[strcspn(operator_name, "\n")] = 0;
+
+    char sql[512] = "SELECT logged_at, operator, action, table_name, record_id FROM audit_log WHERE 1";
+    if (strlen(table) > 0) strcat(sql, " AND table_name = :table");
+    if (strlen(record) > 0) strcat(sql, " AND record_id = :record");
+    if (strlen(operator_name) > 0) strcat(sql, " AND operator = :operator");
+    strcat(sql, " ORDER BY logged_at DESC LIMIT 50;");
+
+    AuditEntry *entries = calloc(branch_count * 50, sizeof(AuditEntry));
+    int entry_count = 0;
+
+    for (int b = 0; b < branch_count; b++) {
+        sqlite3 *db = branches[b].db;
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement (%s): %s\n", branches[b].name, sqlite3_errmsg(db));
+            continue;
+        }
+        sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":table"), table, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":record"), atoll(record));
+        sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":operator"), operator_name, -1, SQLITE_STATIC);
+
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            AuditEntry *entry = &entries[entry_count++];
+            entry->branch = b;
+            entry->logged_at = sqlite3_column_int64(stmt, 0);
+            snprintf(entry->operator_name, sizeof(entry->operator_name), "%s", (const char *)sqlite3_column_text(stmt, 1));
+            snprintf(entry->action, sizeof(entry->action), "%s", (const char *)sqlite3_column_text(stmt, 2));
+            snprintf(entry->table_name, sizeof(entry->table_name), "%s", (const char *)sqlite3_column_text(stmt, 3));
+            entry->record_id = sqlite3_column_int64(stmt, 4);
+        }
+        if (rc != SQLITE_DONE) {
+            fprintf(stderr, "Error fetching data (%s): %s\n", branches[b].name, sqlite3_errmsg(db));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    qsort(entries, entry_count, sizeof(AuditEntry), compare_audit_entries);
+
+    printf("\n%-12s %-20s %-15s %-7s %-15s %-10s\n", "Branch", "When", "Operator", "Action", "Table", "Record ID");
+    printf("------------ -------------------- --------------- ------- --------------- ----------\n");
+    for (int i = 0; i < entry_count && i < 50; i++) {
+        char when[32];
+        time_t seconds = (time_t)(entries[i].logged_at / 1000);
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&seconds));
+        printf("%-12s %-20s %-15s %-7s %-15s %-10lld\n",
+               branches[entries[i].branch].name, when, entries[i].operator_name,
+               entries[i].action, entries[i].table_name, entries[i].record_id);
+    }
+    free(entries);
+
+    printf("\nShowing up to 50 most recent entries.\n");
     wait_for_enter();
 }
 
@@ -452,11 +1950,10 @@ void clear_input_buffer() {
 // Main Function
 int main() {
     clear_screen();
-    // connect_database();
-    // initialize_database(db);
+    connect_database();
 
     show_main_menu();
 
-    // sqlite3_close(db);
+    close_database();
     return 0;
 }
@@ -8,11 +8,17 @@ CREATE TABLE IF NOT EXISTS patients (
     gender TEXT CHECK(gender IN ('M','F','O'))
 );
 
+CREATE TABLE IF NOT EXISTS specializations (
+    specialization_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    name TEXT NOT NULL UNIQUE COLLATE NOCASE
+);
+
 CREATE TABLE IF NOT EXISTS doctors (
     doctor_id INTEGER PRIMARY KEY AUTOINCREMENT,
     full_name TEXT NOT NULL,
     specialization TEXT NOT NULL,
-    contact TEXT NOT NULL
+    contact TEXT NOT NULL,
+    specialization_id INTEGER REFERENCES specializations(specialization_id)
 );
 
 CREATE TABLE IF NOT EXISTS appointments (
@@ -21,6 +27,37 @@ CREATE TABLE IF NOT EXISTS appointments (
     doctor_id INTEGER NOT NULL,
     appointment_date TEXT NOT NULL CHECK(appointment_date GLOB '????-??-??'),
     appointment_time TEXT NOT NULL CHECK(appointment_time GLOB '??:??'),
+    duration_minutes INTEGER NOT NULL DEFAULT 15 CHECK(duration_minutes > 0),
     FOREIGN KEY(patient_id) REFERENCES patients(patient_id) ON DELETE CASCADE,
     FOREIGN KEY(doctor_id) REFERENCES doctors(doctor_id) ON DELETE CASCADE
-);
\ No newline at end of file
+);
+
+-- Indexes backing search and filtering
+CREATE INDEX IF NOT EXISTS idx_appointments_doctor_date ON appointments(doctor_id, appointment_date);
+CREATE INDEX IF NOT EXISTS idx_appointments_patient_date ON appointments(patient_id, appointment_date);
+CREATE INDEX IF NOT EXISTS idx_appointments_date ON appointments(appointment_date);
+CREATE INDEX IF NOT EXISTS idx_doctors_specialization_id ON doctors(specialization_id);
+
+-- Interval index for overlap detection: one box per appointment spanning
+-- [doctor_id, doctor_id] x [start, start + duration) in minutes since epoch
+CREATE VIRTUAL TABLE IF NOT EXISTS appointment_intervals USING rtree_i32(
+    appointment_id, doctor_lo, doctor_hi, start_minute, end_minute
+);
+
+CREATE TRIGGER IF NOT EXISTS trg_appointment_intervals_insert AFTER INSERT ON appointments BEGIN
+    INSERT INTO appointment_intervals VALUES (NEW.appointment_id, NEW.doctor_id, NEW.doctor_id,
+        strftime('%s', NEW.appointment_date || ' ' || NEW.appointment_time) / 60,
+        strftime('%s', NEW.appointment_date || ' ' || NEW.appointment_time) / 60 + NEW.duration_minutes);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_appointment_intervals_update
+AFTER UPDATE OF doctor_id, appointment_date, appointment_time, duration_minutes ON appointments BEGIN
+    UPDATE appointment_intervals SET doctor_lo = NEW.doctor_id, doctor_hi = NEW.doctor_id,
+        start_minute = strftime('%s', NEW.appointment_date || ' ' || NEW.appointment_time) / 60,
+        end_minute = strftime('%s', NEW.appointment_date || ' ' || NEW.appointment_time) / 60 + NEW.duration_minutes
+    WHERE appointment_id = NEW.appointment_id;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_appointment_intervals_delete AFTER DELETE ON appointments BEGIN
+    DELETE FROM appointment_intervals WHERE appointment_id = OLD.appointment_id;
+END;
@@ -1,8 +1,29 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <ctype.h>
+#include <limits.h>
 #include <sqlite3.h>
 
 #define DB_NAME "appointment.db"
+#define DEFAULT_DURATION_MINUTES 15
+#define SCHEDULE_DAY_START (9 * 60)
+#define SCHEDULE_SLOT_MINUTES 15
+#define SCHEDULE_SLOTS_PER_DAY 32
+#define SCHEDULE_MORNING 0x00000FFFu
+#define SCHEDULE_AFTERNOON 0xFFFFF000u
+#define SCHEDULE_MAX_DAYS 366
+#define COHORT_MAX_AGE 150
+#define COHORT_WEIGHT_BINS_PER_KG 10   // Weight percentiles are exact to 0.1 kg
+#define COHORT_WEIGHT_BINS (300 * COHORT_WEIGHT_BINS_PER_KG)
+#define COHORT_WEIGHT_BANDS 15         // 10 kg bands, the last one open-ended
+#define COHORT_GENDERS 4               // M, F, O, not recorded
+#define COHORT_BAR_WIDTH 40
+#define CALENDAR_WINDOW_WEEKS 5        // Weeks fetched per query, centred on the one shown
+#define CALENDAR_CELL_WIDTH 11
+#define CALENDAR_BUFFER_SIZE 8192
 #define get_input(variable, prompt) { \
     printf("%s", prompt); \
     fgets(variable, sizeof(variable), stdin); \
@@ -12,10 +33,15 @@
 // Global database connection
 sqlite3 *db;
 
+// Shared with the clinic programs in ../CAMS
+#include "../common/schema_helpers.h"
+#include "../common/specialization_cache.h"
+
 // DB Function Prototypes
 void connect_database();
 void initialize_database();
 void execute_sql(sqlite3 *db, const char *sql);
+int table_exists(const char *table);
 
 // Common Functions
 void wait_for_enter();
@@ -28,10 +54,84 @@ void patient_menu();
 void doctor_menu();
 void appointment_menu();
 
+// Appointment Functions
+void add_appointment();
+int find_overlapping_appointment(int doctor_id, const char *date, const char *time, int duration_minutes);
+
+// Batch Scheduler
+typedef struct {
+    int line;
+    int patient_id;
+    char specialization[64];
+    int specialization_id;
+    int earliest_day;
+    int latest_day;
+    unsigned int window;
+    int duration_minutes;
+    int slots;
+    int patient;    // index into the batch's patient IDs
+    int doctor;     // index into the doctor table, -1 if unscheduled
+    int day;
+    int slot;
+} ScheduleRequest;
+
+typedef struct {
+    int doctor_id;
+    int specialization_id;
+    int load;       // appointments held, including this batch
+    int assigned;   // appointments added by this batch
+} ScheduleDoctor;
+
+void batch_schedule_appointments();
+
+// Search Functions
+void search_appointments();
+
+// Cohort Statistics
+typedef struct {
+    int count;
+    int max_patient_id;
+    int *ages;              // 0 = not recorded
+    float *weights;         // 0 = not recorded
+    unsigned char *genders; // 0 = M, 1 = F, 2 = O, 3 = not recorded
+    int *row_of_patient;    // patient_id -> row, -1 if none
+} PatientColumns;
+
+typedef struct {
+    int doctor_id;
+    char name[64];
+    int patients;
+    int aged, weighed;
+    double age_sum, weight_sum;
+    int genders[COHORT_GENDERS];
+} CohortDoctor;
+
+void cohort_statistics();
+
+// Weekly Calendar
+typedef struct {
+    int day;                // Days since 1970-01-01
+    int start_minute;       // Minutes after midnight
+    int duration_minutes;
+    char patient[32];
+} CalendarEntry;
+
+typedef struct {
+    int doctor_id;          // One doctor, or
+    int specialization_id;  // every doctor of a specialization
+    char title[64];
+    int first_day;          // First day of the loaded window
+    CalendarEntry *entries;
+    int count, capacity;
+} CalendarView;
+
+void view_calendar();
+
 int main() {
     clear_screen();
     connect_database();
     initialize_database(db);
+    load_specializations();
     main_menu();
     return 0;
 }
@@ -92,11 +192,17 @@ void initialize_database(sqlite3 *db) {
         "gender TEXT CHECK(gender IN ('M','F','O'))"
         "); "
 
+        "CREATE TABLE IF NOT EXISTS specializations ("
+        "specialization_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "name TEXT NOT NULL UNIQUE COLLATE NOCASE"
+        "); "
+
         "CREATE TABLE IF NOT EXISTS doctors ("
         "doctor_id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "full_name TEXT NOT NULL, "
         "specialization TEXT NOT NULL, "
-        "contact TEXT NOT NULL"
+        "contact TEXT NOT NULL, "
+        "specialization_id INTEGER REFERENCES specializations(specialization_id)"
         "); "
 
         "CREATE TABLE IF NOT EXISTS appointments ("
@@ -105,11 +211,88 @@ void initialize_database(sqlite3 *db) {
         "doctor_id INTEGER NOT NULL, "
         "appointment_date TEXT NOT NULL CHECK(appointment_date GLOB '????-??-??'), "
         "appointment_time TEXT NOT NULL CHECK(appointment_time GLOB '??:??'), "
+        "duration_minutes INTEGER NOT NULL DEFAULT 15 CHECK(duration_minutes > 0), "
         "FOREIGN KEY(patient_id) REFERENCES patients(patient_id) ON DELETE CASCADE, "
         "FOREIGN KEY(doctor_id) REFERENCES doctors(doctor_id) ON DELETE CASCADE"
-        ");";
+        "); "
+
+        // Indexes backing search and filtering
+        "CREATE INDEX IF NOT EXISTS idx_appointments_doctor_date ON appointments(doctor_id, appointment_date); "
+        "CREATE INDEX IF NOT EXISTS idx_appointments_patient_date ON appointments(patient_id, appointment_date); "
+        "CREATE INDEX IF NOT EXISTS idx_appointments_date ON appointments(appointment_date);";
 
     execute_sql(db, sql);
+
+    // Specializations used to be free text on each doctor. Every distinct
+    // spelling (matched case-insensitively) becomes a dictionary entry and
+    // doctors are pointed at it; afterwards this only touches new rows.
+    if (!column_exists(db, "doctors", "specialization_id")) {
+        execute_sql(db, "ALTER TABLE doctors ADD COLUMN specialization_id INTEGER REFERENCES specializations(specialization_id);");
+    }
+    run_migration(db,
+        "INSERT OR IGNORE INTO specializations (name) "
+        "SELECT TRIM(specialization) FROM doctors WHERE specialization_id IS NULL; "
+        "UPDATE doctors SET specialization_id = "
+        "(SELECT specialization_id FROM specializations WHERE name = TRIM(doctors.specialization)) "
+        "WHERE specialization_id IS NULL;");
+    execute_sql(db,
+        "DROP INDEX IF EXISTS idx_doctors_specialization; "
+        "CREATE INDEX IF NOT EXISTS idx_doctors_specialization_id ON doctors(specialization_id);");
+
+    // Databases created before appointments had a duration
+    if (!column_exists(db, "appointments", "duration_minutes")) {
+        execute_sql(db, "ALTER TABLE appointments ADD COLUMN duration_minutes "
+                        "INTEGER NOT NULL DEFAULT 15 CHECK(duration_minutes > 0);");
+    }
+
+    // Interval index: one R*Tree box per appointment, spanning
+    // [doctor, doctor] x [start, end) in minutes since 1970-01-01. The
+    // triggers keep it in step with the appointments table, so an overlap
+    // check is a single logarithmic R*Tree search.
+    int backfill = !table_exists("appointment_intervals");
+    const char *interval_sql =
+        "CREATE VIRTUAL TABLE IF NOT EXISTS appointment_intervals USING rtree_i32("
+        "appointment_id, doctor_lo, doctor_hi, start_minute, end_minute); "
+
+        "CREATE TRIGGER IF NOT EXISTS trg_appointment_intervals_insert AFTER INSERT ON appointments BEGIN "
+        "INSERT INTO appointment_intervals VALUES (NEW.appointment_id, NEW.doctor_id, NEW.doctor_id, "
+        "strftime('%s', NEW.appointment_date || ' ' || NEW.appointment_time) / 60, "
+        "strftime('%s', NEW.appointment_date || ' ' || NEW.appointment_time) / 60 + NEW.duration_minutes); "
+        "END; "
+
+        "CREATE TRIGGER IF NOT EXISTS trg_appointment_intervals_update "
+        "AFTER UPDATE OF doctor_id, appointment_date, appointment_time, duration_minutes ON appointments BEGIN "
+        "UPDATE appointment_intervals SET doctor_lo = NEW.doctor_id, doctor_hi = NEW.doctor_id, "
+        "start_minute = strftime('%s', NEW.appointment_date || ' ' || NEW.appointment_time) / 60, "
+        "end_minute = strftime('%s', NEW.appointment_date || ' ' || NEW.appointment_time) / 60 + NEW.duration_minutes "
+        "WHERE appointment_id = NEW.appointment_id; "
+        "END; "
+
+        "CREATE TRIGGER IF NOT EXISTS trg_appointment_intervals_delete AFTER DELETE ON appointments BEGIN "
+        "DELETE FROM appointment_intervals WHERE appointment_id = OLD.appointment_id; "
+        "END;";
+    execute_sql(db, interval_sql);
+
+    if (backfill) {
+        execute_sql(db,
+            "INSERT INTO appointment_intervals "
+            "SELECT appointment_id, doctor_id, doctor_id, "
+            "strftime('%s', appointment_date || ' ' || appointment_time) / 60, "
+            "strftime('%s', appointment_date || ' ' || appointment_time) / 60 + duration_minutes "
+            "FROM appointments;");
+    }
+}
+
+// Returns 1 if a table (or virtual table) with this name exists
+int table_exists(const char *table) {
+    sqlite3_stmt *stmt;
+    int exists = 0;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC);
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+    return exists;
 }
 
 // Main menu
@@ -120,6 +303,8 @@ void main_menu() {
         printf("1. Patient Management\n");
         printf("2. Doctor Management\n");
         printf("3. Appointment Management\n");
+        printf("4. Search and Filter Appointments\n");
+        printf("5. Patient Cohort Statistics\n");
         printf("0. Exit\n");
         printf("Enter your Choice: ");
         scanf("%d", &choice);
@@ -138,6 +323,14 @@ void main_menu() {
                 clear_screen();
                 appointment_menu();
                 break;
+            case 4: 
+                clear_screen();
+                search_appointments();
+                break;
+            case 5: 
+                clear_screen();
+                cohort_statistics();
+                break;
             case 0: 
                 sqlite3_close(db);
                 printf("Exiting program.....\n");
@@ -253,6 +446,7 @@ void appointment_menu() {
         printf("2. View Appointments\n");
         printf("3. Edit Appointment\n");
         printf("4. Delete Appointment\n");
+        printf("5. Batch Schedule from File\n");
         printf("0. Back to Main Menu\n\n");
         printf("Choice: ");
         scanf("%d", &choice);
@@ -261,16 +455,12 @@ void appointment_menu() {
 
         switch(choice) {
             case 1: 
-                // Add appointment functionality
                 clear_screen();
-                printf("Add New appointment...\n");
-                wait_for_enter();
+                add_appointment();
                 break;
             case 2: 
-                // View appointment functionality
                 clear_screen();
-                printf("View appointments...\n");
-                wait_for_enter();
+                view_calendar();
                 break;
             case 3: 
                 // Edit appointment functionality
@@ -284,6 +474,10 @@ void appointment_menu() {
                 printf("Delete appointment...\n");
                 wait_for_enter();
                 break;
+            case 5:
+                clear_screen();
+                batch_schedule_appointments();
+                break;
             case 0: 
                 clear_screen();
                 return; // Go back to main menu
@@ -292,3 +486,1077 @@ void appointment_menu() {
         }
     }
 }
+
+// Returns the ID of an existing appointment of the doctor that overlaps the
+// half-open interval [date time, date time + duration), or 0 if the doctor is
+// free. Back-to-back appointments do not overlap.
+int find_overlapping_appointment(int doctor_id, const char *date, const char *time, int duration_minutes) {
+    const char *sql =
+        "SELECT appointment_id FROM appointment_intervals "
+        "WHERE doctor_lo <= ?1 AND doctor_hi >= ?1 "
+        "AND start_minute < strftime('%s', ?2 || ' ' || ?3) / 60 + ?4 "
+        "AND end_minute > strftime('%s', ?2 || ' ' || ?3) / 60 "
+        "LIMIT 1;";
+    sqlite3_stmt *stmt;
+    int appointment_id = 0;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, doctor_id);
+    sqlite3_bind_text(stmt, 2, date, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, time, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, duration_minutes);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        appointment_id = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return appointment_id;
+}
+
+// Book an appointment with a duration, refusing any overlap with the
+// doctor's existing appointments
+void add_appointment() {
+    char patient_id[16], doctor_id[16], date[16], time[16], duration[16];
+    int year, month, day, hour, minute;
+
+    printf("\n=== ADD NEW APPOINTMENT ===\n");
+    get_input(patient_id, "Patient ID: ");
+    get_input(doctor_id, "Doctor ID: ");
+    get_input(date, "Date (YYYY-MM-DD): ");
+    get_input(time, "Time (HH:MM): ");
+    get_input(duration, "Duration in minutes (Enter for 15): ");
+
+    int duration_minutes = strlen(duration) > 0 ? atoi(duration) : DEFAULT_DURATION_MINUTES;
+    if (strlen(date) != 10 || sscanf(date, "%4d-%2d-%2d", &year, &month, &day) != 3 ||
+        month < 1 || month > 12 || day < 1 || day > 31) {
+        printf("Invalid date. Please use YYYY-MM-DD.\n");
+        wait_for_enter();
+        return;
+    }
+    if (strlen(time) != 5 || sscanf(time, "%2d:%2d", &hour, &minute) != 2 ||
+        hour > 23 || minute > 59) {
+        printf("Invalid time. Please use HH:MM.\n");
+        wait_for_enter();
+        return;
+    }
+    if (duration_minutes <= 0) {
+        printf("Duration must be a positive number of minutes.\n");
+        wait_for_enter();
+        return;
+    }
+
+    execute_sql(db, "BEGIN IMMEDIATE;");
+
+    int conflict = find_overlapping_appointment(atoi(doctor_id), date, time, duration_minutes);
+    if (conflict != 0) {
+        execute_sql(db, "ROLLBACK;");
+        if (conflict > 0) {
+            printf("\nDoctor %s is already booked during that time (appointment ID %d).\n", doctor_id, conflict);
+        }
+        wait_for_enter();
+        return;
+    }
+
+    sqlite3_stmt *stmt;
+    const char *sql =
+        "INSERT INTO appointments (patient_id, doctor_id, appointment_date, appointment_time, duration_minutes) "
+        "SELECT p.patient_id, d.doctor_id, ?3, ?4, ?5 FROM patients p, doctors d "
+        "WHERE p.patient_id = ?1 AND d.doctor_id = ?2;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        execute_sql(db, "ROLLBACK;");
+        wait_for_enter();
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, atoi(patient_id));
+    sqlite3_bind_int(stmt, 2, atoi(doctor_id));
+    sqlite3_bind_text(stmt, 3, date, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, time, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 5, duration_minutes);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        execute_sql(db, "ROLLBACK;");
+    } else if (sqlite3_changes(db) == 0) {
+        sqlite3_finalize(stmt);
+        execute_sql(db, "ROLLBACK;");
+        printf("\nPatient %s or doctor %s does not exist.\n", patient_id, doctor_id);
+    } else {
+        sqlite3_finalize(stmt);
+        execute_sql(db, "COMMIT;");
+        printf("\nAppointment %lld booked: %s %s for %d minutes.\n",
+               (long long)sqlite3_last_insert_rowid(db), date, time, duration_minutes);
+    }
+    wait_for_enter();
+}
+
+// Search appointments by any combination of patient, doctor, specialization
+// and date range. Only the filters that are filled in become part of the
+// query, so SQLite can pick the matching index:
+//   patient (+ dates)        -> idx_appointments_patient_date
+//   doctor (+ dates)         -> idx_appointments_doctor_date
+//   specialization (+ dates) -> idx_doctors_specialization_id, then per doctor
+//                               idx_appointments_doctor_date
+//   dates only               -> idx_appointments_date
+void search_appointments() {
+    char patient_id[16], doctor_id[16], specialization[100], date_from[16], date_to[16];
+
+    printf("\n=== SEARCH AND FILTER APPOINTMENTS ===\n");
+    printf("Leave a filter blank to ignore it.\n\n");
+    get_input(patient_id, "Patient ID: ");
+    get_input(doctor_id, "Doctor ID: ");
+    get_input(specialization, "Specialization: ");
+    get_input(date_from, "From date (YYYY-MM-DD): ");
+    get_input(date_to, "To date (YYYY-MM-DD): ");
+
+    int specialization_id = 0;
+    if (strlen(specialization) > 0 && (specialization_id = find_specialization(specialization)) == 0) {
+        printf("\nUnknown specialization: %s\n", specialization);
+        wait_for_enter();
+        return;
+    }
+
+    char sql[1024] =
+        "SELECT a.appointment_id, p.full_name, d.full_name, d.specialization_id, "
+        "a.appointment_date, a.appointment_time "
+        "FROM appointments a "
+        "JOIN patients p ON p.patient_id = a.patient_id "
+        "JOIN doctors d ON d.doctor_id = a.doctor_id "
+        "WHERE 1";
+    if (strlen(patient_id) > 0) strcat(sql, " AND a.patient_id = :patient");
+    if (strlen(doctor_id) > 0) strcat(sql, " AND a.doctor_id = :doctor");
+    if (strlen(specialization) > 0) strcat(sql, " AND d.specialization_id = :specialization");
+    if (strlen(date_from) > 0) strcat(sql, " AND a.appointment_date >= :date_from");
+    if (strlen(date_to) > 0) strcat(sql, " AND a.appointment_date <= :date_to");
+    strcat(sql, " ORDER BY a.appointment_date, a.appointment_time;");
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        wait_for_enter();
+        return;
+    }
+    sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":patient"), atoi(patient_id));
+    sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":doctor"), atoi(doctor_id));
+    sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":specialization"), specialization_id);
+    sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":date_from"), date_from, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":date_to"), date_to, -1, SQLITE_STATIC);
+
+    printf("\n%-5s %-25s %-25s %-20s %-12s %-5s\n", "ID", "Patient", "Doctor", "Specialization", "Date", "Time");
+    printf("----- ------------------------- ------------------------- -------------------- ------------ -----\n");
+
+    int count = 0, rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        printf("%-5d %-25s %-25s %-20s %-12s %-5s\n",
+               sqlite3_column_int(stmt, 0),
+               (const char *)sqlite3_column_text(stmt, 1),
+               (const char *)sqlite3_column_text(stmt, 2),
+               specialization_name(sqlite3_column_int(stmt, 3)),
+               (const char *)sqlite3_column_text(stmt, 4),
+               (const char *)sqlite3_column_text(stmt, 5));
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+
+    printf("\n%d appointment(s) found.\n", count);
+    wait_for_enter();
+}
+
+// Batch Scheduler
+//
+// Assigns a whole file of pending requests in one run. Working hours are
+// cut into 15-minute slots and each doctor-day is a 32-bit busy mask, so
+// finding a free run of N slots in a window is a handful of shifts and ANDs.
+// Requests are placed earliest-deadline first; each goes to the earliest
+// free slot among doctors of the requested specialization, ties going to
+// the doctor with the fewest appointments so far. Patients get busy masks
+// too, so no one is booked into two overlapping slots. The whole run, from
+// reading the existing appointments to inserting the result, is a single
+// write transaction, so bookings made elsewhere cannot slip in between.
+//
+// Request file, one request per line ('#' starts a comment):
+//   patient_id,specialization,earliest_date,latest_date[,morning|afternoon|any[,duration]]
+
+int days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void civil_from_days(int z, int *y, int *m, int *d) {
+    z += 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp + (mp < 10 ? 3 : -9);
+    *y = yoe + era * 400 + (*m <= 2);
+}
+
+int parse_date(const char *date, int *day) {
+    int y, m, d;
+    if (strlen(date) != 10 || sscanf(date, "%4d-%2d-%2d", &y, &m, &d) != 3 ||
+        m < 1 || m > 12 || d < 1 || d > 31) {
+        return 0;
+    }
+    *day = days_from_civil(y, m, d);
+    return 1;
+}
+
+// Slot 0 starts at 09:00, slot 31 ends at 17:00
+int slot_start_minute(int slot) {
+    return SCHEDULE_DAY_START + slot * SCHEDULE_SLOT_MINUTES;
+}
+
+// Mask of slots at which a run of `slots` consecutive free slots starts
+unsigned int free_run_starts(unsigned int free, int slots) {
+    unsigned int starts = free;
+    for (int k = 1; k < slots && starts; k++) {
+        starts &= free >> k;
+    }
+    return starts;
+}
+
+int lowest_bit(unsigned int mask) {
+    int bit = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+}
+
+int compare_schedule_requests(const void *a, const void *b) {
+    const ScheduleRequest *x = a;
+    const ScheduleRequest *y = b;
+    if (x->latest_day != y->latest_day) return x->latest_day < y->latest_day ? -1 : 1;
+    if (x->earliest_day != y->earliest_day) return x->earliest_day < y->earliest_day ? -1 : 1;
+    return x->line - y->line;
+}
+
+int find_doctor_index(const ScheduleDoctor *doctors, int count, int doctor_id) {
+    int lo = 0, hi = count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (doctors[mid].doctor_id == doctor_id) return mid;
+        if (doctors[mid].doctor_id < doctor_id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+int find_patient_index(const int *patient_ids, int count, int patient_id) {
+    const int *found = bsearch(&patient_id, patient_ids, count, sizeof(int), compare_ints);
+    return found ? (int)(found - patient_ids) : -1;
+}
+
+// Marks the slots covered by an appointment in a day's busy mask
+void mark_busy_slots(unsigned int *mask, int hour, int minute, int duration_minutes) {
+    int start = hour * 60 + minute - SCHEDULE_DAY_START;
+    int end = start + duration_minutes;
+    int first_slot = start < 0 ? 0 : start / SCHEDULE_SLOT_MINUTES;
+    int last_slot = (end + SCHEDULE_SLOT_MINUTES - 1) / SCHEDULE_SLOT_MINUTES;
+    if (last_slot > SCHEDULE_SLOTS_PER_DAY) last_slot = SCHEDULE_SLOTS_PER_DAY;
+    for (int slot = first_slot; slot < last_slot; slot++) {
+        *mask |= 1u << slot;
+    }
+}
+
+// Reads and validates the request file. Returns the number of requests
+// loaded, or -1 if the file could not be read.
+int load_schedule_requests(const char *path, ScheduleRequest **out) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return -1;
+    }
+
+    sqlite3_stmt *patient_stmt;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM patients WHERE patient_id = ?;", -1, &patient_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        fclose(file);
+        return -1;
+    }
+
+    int capacity = 256, count = 0, line_no = 0;
+    ScheduleRequest *requests = malloc(capacity * sizeof(ScheduleRequest));
+    char line[512];
+
+    while (requests && fgets(line, sizeof(line), file)) {
+        line_no++;
+        line[strcspn(line, "\r\n#")] = '\0';
+        if (strspn(line, " \t") == strlen(line)) continue;
+
+        ScheduleRequest r;
+        char earliest[32], latest[32], window[32] = "any";
+        int duration = DEFAULT_DURATION_MINUTES;
+        memset(&r, 0, sizeof(r));
+        r.line = line_no;
+
+        int fields = sscanf(line, " %d , %63[^,] , %31[^, ] , %31[^, ] , %31[^, ] , %d",
+                            &r.patient_id, r.specialization, earliest, latest, window, &duration);
+        r.specialization[strcspn(r.specialization, "\t")] = '\0';
+        for (int i = (int)strlen(r.specialization) - 1; i >= 0 && r.specialization[i] == ' '; i--) {
+            r.specialization[i] = '\0';
+        }
+
+        if (fields < 4 || !parse_date(earliest, &r.earliest_day) || !parse_date(latest, &r.latest_day) ||
+            r.latest_day < r.earliest_day) {
+            printf("Line %d: expected patient_id,specialization,earliest_date,latest_date[,window[,duration]]\n", line_no);
+            continue;
+        }
+        if (r.latest_day - r.earliest_day >= SCHEDULE_MAX_DAYS) {
+            printf("Line %d: date range longer than %d days\n", line_no, SCHEDULE_MAX_DAYS);
+            continue;
+        }
+        if (strcmp(window, "morning") == 0) {
+            r.window = SCHEDULE_MORNING;
+        } else if (strcmp(window, "afternoon") == 0) {
+            r.window = SCHEDULE_AFTERNOON;
+        } else if (strcmp(window, "any") == 0) {
+            r.window = SCHEDULE_MORNING | SCHEDULE_AFTERNOON;
+        } else {
+            printf("Line %d: window must be morning, afternoon or any\n", line_no);
+            continue;
+        }
+        r.slots = (duration + SCHEDULE_SLOT_MINUTES - 1) / SCHEDULE_SLOT_MINUTES;
+        r.duration_minutes = duration;
+        if (duration <= 0 || r.slots > SCHEDULE_SLOTS_PER_DAY) {
+            printf("Line %d: duration must be between 1 and %d minutes\n", line_no,
+                   SCHEDULE_SLOTS_PER_DAY * SCHEDULE_SLOT_MINUTES);
+            continue;
+        }
+
+        r.specialization_id = find_specialization(r.specialization);
+        if (r.specialization_id == 0) {
+            printf("Line %d: unknown specialization %s\n", line_no, r.specialization);
+            continue;
+        }
+
+        sqlite3_bind_int(patient_stmt, 1, r.patient_id);
+        int exists = sqlite3_step(patient_stmt) == SQLITE_ROW;
+        sqlite3_reset(patient_stmt);
+        if (!exists) {
+            printf("Line %d: patient %d does not exist\n", line_no, r.patient_id);
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity *= 2;
+            ScheduleRequest *grown = realloc(requests, capacity * sizeof(ScheduleRequest));
+            if (!grown) break;
+            requests = grown;
+        }
+        requests[count++] = r;
+    }
+
+    sqlite3_finalize(patient_stmt);
+    fclose(file);
+    if (!requests) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    *out = requests;
+    return count;
+}
+
+void batch_schedule_appointments() {
+    char path[256];
+    ScheduleRequest *requests = NULL;
+    ScheduleDoctor *doctors = NULL;
+    int *patient_ids = NULL;
+    unsigned int *busy = NULL, *patient_busy = NULL;
+    sqlite3_stmt *stmt = NULL;
+    char *err_msg = NULL;
+    int doctor_count = 0, doctor_capacity = 64, patient_count = 0;
+
+    printf("\n=== BATCH SCHEDULE APPOINTMENTS ===\n");
+    printf("Each line: patient_id,specialization,earliest_date,latest_date[,morning|afternoon|any[,duration]]\n\n");
+    get_input(path, "Request file: ");
+
+    // Hold the write lock from the first read to the last insert, so the
+    // plan is made against the appointments it is committed on top of
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "Cannot start the batch: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        printf("No appointments were booked.\n");
+        wait_for_enter();
+        return;
+    }
+
+    clock_t started = clock();
+    int request_count = load_schedule_requests(path, &requests);
+    if (request_count <= 0) {
+        if (request_count == 0) printf("No valid requests to schedule.\n");
+        goto rollback;
+    }
+
+    // Distinct patients of the batch, sorted for binary search
+    patient_ids = malloc(request_count * sizeof(int));
+    if (!patient_ids) {
+        fprintf(stderr, "Out of memory\n");
+        goto rollback;
+    }
+    for (int i = 0; i < request_count; i++) {
+        patient_ids[i] = requests[i].patient_id;
+    }
+    qsort(patient_ids, request_count, sizeof(int), compare_ints);
+    for (int i = 0; i < request_count; i++) {
+        if (patient_count == 0 || patient_ids[patient_count - 1] != patient_ids[i]) {
+            patient_ids[patient_count++] = patient_ids[i];
+        }
+    }
+    for (int i = 0; i < request_count; i++) {
+        requests[i].patient = find_patient_index(patient_ids, patient_count, requests[i].patient_id);
+    }
+
+    // Doctors, sorted by ID so busy slots can be looked up by binary search
+    doctors = malloc(doctor_capacity * sizeof(ScheduleDoctor));
+    if (sqlite3_prepare_v2(db, "SELECT doctor_id, specialization_id, "
+                               "(SELECT COUNT(*) FROM appointments a WHERE a.doctor_id = d.doctor_id) "
+                               "FROM doctors d ORDER BY doctor_id;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        goto rollback;
+    }
+    while (doctors && sqlite3_step(stmt) == SQLITE_ROW) {
+        if (doctor_count == doctor_capacity) {
+            doctor_capacity *= 2;
+            ScheduleDoctor *grown = realloc(doctors, doctor_capacity * sizeof(ScheduleDoctor));
+            if (!grown) break;
+            doctors = grown;
+        }
+        ScheduleDoctor *doctor = &doctors[doctor_count++];
+        doctor->doctor_id = sqlite3_column_int(stmt, 0);
+        doctor->specialization_id = sqlite3_column_int(stmt, 1);
+        doctor->load = sqlite3_column_int(stmt, 2);
+        doctor->assigned = 0;
+    }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+    if (!doctors || doctor_count == 0) {
+        printf("No doctors available.\n");
+        goto rollback;
+    }
+
+    // Busy masks for every doctor-day and patient-day in the window the
+    // requests cover
+    int first_day = requests[0].earliest_day, last_day = requests[0].latest_day;
+    for (int i = 1; i < request_count; i++) {
+        if (requests[i].earliest_day < first_day) first_day = requests[i].earliest_day;
+        if (requests[i].latest_day > last_day) last_day = requests[i].latest_day;
+    }
+    int day_count = last_day - first_day + 1;
+    busy = calloc((size_t)doctor_count * day_count, sizeof(unsigned int));
+    patient_busy = calloc((size_t)patient_count * day_count, sizeof(unsigned int));
+    if (!busy || !patient_busy) {
+        fprintf(stderr, "Out of memory\n");
+        goto rollback;
+    }
+
+    char from_date[11], to_date[11];
+    int y, m, d;
+    civil_from_days(first_day, &y, &m, &d);
+    snprintf(from_date, sizeof(from_date), "%04d-%02d-%02d", y, m, d);
+    civil_from_days(last_day, &y, &m, &d);
+    snprintf(to_date, sizeof(to_date), "%04d-%02d-%02d", y, m, d);
+
+    if (sqlite3_prepare_v2(db, "SELECT doctor_id, patient_id, appointment_date, appointment_time, duration_minutes "
+                               "FROM appointments WHERE appointment_date BETWEEN ? AND ?;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        goto rollback;
+    }
+    sqlite3_bind_text(stmt, 1, from_date, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, to_date, -1, SQLITE_STATIC);
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int doctor = find_doctor_index(doctors, doctor_count, sqlite3_column_int(stmt, 0));
+        int patient = find_patient_index(patient_ids, patient_count, sqlite3_column_int(stmt, 1));
+        int day, hour, minute;
+        if (!parse_date((const char *)sqlite3_column_text(stmt, 2), &day) ||
+            sscanf((const char *)sqlite3_column_text(stmt, 3), "%d:%d", &hour, &minute) != 2) {
+            continue;
+        }
+        int duration_minutes = sqlite3_column_int(stmt, 4);
+        if (doctor >= 0) {
+            mark_busy_slots(&busy[(size_t)doctor * day_count + (day - first_day)], hour, minute, duration_minutes);
+        }
+        if (patient >= 0) {
+            mark_busy_slots(&patient_busy[(size_t)patient * day_count + (day - first_day)], hour, minute, duration_minutes);
+        }
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        goto rollback;
+    }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+
+    // Earliest deadline first, then greedy earliest slot with load balancing
+    qsort(requests, request_count, sizeof(ScheduleRequest), compare_schedule_requests);
+    int scheduled = 0;
+    for (int i = 0; i < request_count; i++) {
+        ScheduleRequest *r = &requests[i];
+        r->doctor = -1;
+        for (int day = r->earliest_day; day <= r->latest_day && r->doctor < 0; day++) {
+            int best_slot = SCHEDULE_SLOTS_PER_DAY;
+            unsigned int *patient_day = &patient_busy[(size_t)r->patient * day_count + (day - first_day)];
+            for (int doctor = 0; doctor < doctor_count; doctor++) {
+                if (doctors[doctor].specialization_id != r->specialization_id) continue;
+                unsigned int available = ~(busy[(size_t)doctor * day_count + (day - first_day)] | *patient_day);
+                unsigned int starts = free_run_starts(available & r->window, r->slots);
+                if (!starts) continue;
+                int slot = lowest_bit(starts);
+                if (slot < best_slot || (slot == best_slot && doctors[doctor].load < doctors[r->doctor].load)) {
+                    best_slot = slot;
+                    r->doctor = doctor;
+                }
+            }
+            if (r->doctor >= 0) {
+                unsigned int run = (r->slots == 32 ? 0xFFFFFFFFu : (1u << r->slots) - 1) << best_slot;
+                busy[(size_t)r->doctor * day_count + (day - first_day)] |= run;
+                *patient_day |= run;
+                doctors[r->doctor].load++;
+                doctors[r->doctor].assigned++;
+                r->day = day;
+                r->slot = best_slot;
+                scheduled++;
+            }
+        }
+    }
+    double plan_seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+
+    // Commit every assignment together
+    if (sqlite3_prepare_v2(db, "INSERT INTO appointments (patient_id, doctor_id, appointment_date, "
+                               "appointment_time, duration_minutes) VALUES (?, ?, ?, ?, ?);", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        goto rollback;
+    }
+    for (int i = 0; i < request_count; i++) {
+        ScheduleRequest *r = &requests[i];
+        if (r->doctor < 0) continue;
+        char date[11], time[16];
+        int start = slot_start_minute(r->slot);
+        civil_from_days(r->day, &y, &m, &d);
+        snprintf(date, sizeof(date), "%04d-%02d-%02d", y, m, d);
+        snprintf(time, sizeof(time), "%02d:%02d", start / 60, start % 60);
+
+        sqlite3_bind_int(stmt, 1, r->patient_id);
+        sqlite3_bind_int(stmt, 2, doctors[r->doctor].doctor_id);
+        sqlite3_bind_text(stmt, 3, date, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, time, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 5, r->duration_minutes);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            fprintf(stderr, "SQL error on line %d: %s\n", r->line, sqlite3_errmsg(db));
+            goto rollback;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        goto rollback;
+    }
+
+    printf("\nScheduled %d of %d requests (%.3f s, %.3f s planning).\n", scheduled, request_count,
+           (double)(clock() - started) / CLOCKS_PER_SEC, plan_seconds);
+    for (int i = 0; i < request_count; i++) {
+        if (requests[i].doctor < 0) {
+            printf("  Unscheduled: line %d (patient %d, %s)\n", requests[i].line,
+                   requests[i].patient_id, specialization_name(requests[i].specialization_id));
+        }
+    }
+    printf("\n%-10s %-20s %10s %10s\n", "Doctor ID", "Specialization", "Assigned", "Total");
+    for (int i = 0; i < doctor_count; i++) {
+        if (doctors[i].assigned > 0) {
+            printf("%-10d %-20s %10d %10d\n", doctors[i].doctor_id, specialization_name(doctors[i].specialization_id),
+                   doctors[i].assigned, doctors[i].load);
+        }
+    }
+    goto cleanup;
+
+rollback:
+    if (stmt) sqlite3_finalize(stmt);
+    stmt = NULL;
+    if (!sqlite3_get_autocommit(db)) execute_sql(db, "ROLLBACK;");
+    printf("No appointments were booked.\n");
+cleanup:
+    if (stmt) sqlite3_finalize(stmt);
+    free(busy);
+    free(patient_busy);
+    free(patient_ids);
+    free(doctors);
+    free(requests);
+    wait_for_enter();
+}
+
+// Cohort Statistics
+//
+// age, weight and gender are read once into contiguous arrays (one column
+// each) and every statistic is computed by plain loops over those arrays.
+// Ages and weights go into fixed-size histograms in a single pass; medians
+// and percentiles are then read off the cumulative histograms, so nothing is
+// sorted. A recorded value is never 0 (the schema requires age > 0 and
+// weight > 0), so 0 marks a value that was not recorded.
+int cohort_gender_index(const unsigned char *gender) {
+    if (gender == NULL) return COHORT_GENDERS - 1;
+    switch (gender[0]) {
+        case 'M': return 0;
+        case 'F': return 1;
+        case 'O': return 2;
+        default: return COHORT_GENDERS - 1;
+    }
+}
+
+// Smallest bin at which the cumulative count reaches the given fraction
+int histogram_percentile(const int *bins, int bin_count, long long total, double fraction) {
+    long long target = (long long)(fraction * total + 0.5);
+    long long seen = 0;
+    if (target < 1) target = 1;
+    for (int i = 0; i < bin_count; i++) {
+        seen += bins[i];
+        if (seen >= target) return i;
+    }
+    return bin_count - 1;
+}
+
+void print_histogram_bar(const char *label, int count, int max_count) {
+    int width = max_count > 0 ? (int)((long long)count * COHORT_BAR_WIDTH / max_count) : 0;
+    printf("%-10s %8d ", label, count);
+    for (int i = 0; i < width; i++) putchar('#');
+    putchar('\n');
+}
+
+int load_patient_columns(PatientColumns *cols) {
+    sqlite3_stmt *stmt;
+    memset(cols, 0, sizeof(*cols));
+
+    if (sqlite3_prepare_v2(db, "SELECT COUNT(*), COALESCE(MAX(patient_id), 0) FROM patients;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        return 0;
+    }
+    int capacity = sqlite3_column_int(stmt, 0);
+    cols->max_patient_id = sqlite3_column_int(stmt, 1);
+    sqlite3_finalize(stmt);
+
+    cols->ages = malloc((capacity + 1) * sizeof(int));
+    cols->weights = malloc((capacity + 1) * sizeof(float));
+    cols->genders = malloc(capacity + 1);
+    cols->row_of_patient = malloc((cols->max_patient_id + 1) * sizeof(int));
+    if (!cols->ages || !cols->weights || !cols->genders || !cols->row_of_patient) {
+        fprintf(stderr, "Out of memory\n");
+        return 0;
+    }
+    for (int i = 0; i <= cols->max_patient_id; i++) cols->row_of_patient[i] = -1;
+
+    if (sqlite3_prepare_v2(db, "SELECT patient_id, age, weight, gender FROM patients;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    int rc = SQLITE_DONE;
+    while (cols->count < capacity && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int row = cols->count++;
+        int patient_id = sqlite3_column_int(stmt, 0);
+        cols->ages[row] = sqlite3_column_int(stmt, 1);
+        cols->weights[row] = (float)sqlite3_column_double(stmt, 2);
+        cols->genders[row] = (unsigned char)cohort_gender_index(sqlite3_column_text(stmt, 3));
+        if (patient_id >= 0 && patient_id <= cols->max_patient_id) cols->row_of_patient[patient_id] = row;
+    }
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        return 0;
+    }
+    sqlite3_finalize(stmt);
+    return 1;
+}
+
+void free_patient_columns(PatientColumns *cols) {
+    free(cols->ages);
+    free(cols->weights);
+    free(cols->genders);
+    free(cols->row_of_patient);
+}
+
+void cohort_statistics() {
+    static const char *gender_names[COHORT_GENDERS] = {"Male", "Female", "Other", "Unknown"};
+    PatientColumns cols;
+    clock_t started = clock();
+
+    printf("\n=== PATIENT COHORT STATISTICS ===\n");
+    int loaded_ok = load_patient_columns(&cols);
+    if (!loaded_ok || cols.count == 0) {
+        if (loaded_ok) printf("No patients recorded.\n");
+        else printf("Could not load the patient data.\n");
+        free_patient_columns(&cols);
+        wait_for_enter();
+        return;
+    }
+    clock_t loaded = clock();
+
+    // One pass over the columns fills every histogram and per-gender sum
+    int *age_bins = calloc(COHORT_MAX_AGE + 1, sizeof(int));
+    int *weight_bins = calloc(COHORT_WEIGHT_BINS, sizeof(int));
+    int gender_count[COHORT_GENDERS] = {0}, gender_aged[COHORT_GENDERS] = {0}, gender_weighed[COHORT_GENDERS] = {0};
+    double gender_age_sum[COHORT_GENDERS] = {0}, gender_weight_sum[COHORT_GENDERS] = {0};
+    if (!age_bins || !weight_bins) {
+        fprintf(stderr, "Out of memory\n");
+        free(age_bins);
+        free(weight_bins);
+        free_patient_columns(&cols);
+        wait_for_enter();
+        return;
+    }
+
+    for (int i = 0; i < cols.count; i++) {
+        int age = cols.ages[i];
+        age = age < 0 ? 0 : (age > COHORT_MAX_AGE ? COHORT_MAX_AGE : age);
+        int bin = (int)(cols.weights[i] * COHORT_WEIGHT_BINS_PER_KG + 0.5f);
+        bin = bin < 0 ? 0 : (bin >= COHORT_WEIGHT_BINS ? COHORT_WEIGHT_BINS - 1 : bin);
+        int g = cols.genders[i];
+
+        age_bins[age]++;
+        weight_bins[bin]++;
+        gender_count[g]++;
+        gender_aged[g] += age > 0;
+        gender_weighed[g] += bin > 0;
+        gender_age_sum[g] += age;
+        gender_weight_sum[g] += cols.weights[i];
+    }
+    // Bin 0 holds the patients without a recorded value
+    long long aged = cols.count - age_bins[0], weighed = cols.count - weight_bins[0];
+    age_bins[0] = 0;
+    weight_bins[0] = 0;
+
+    // Per-doctor breakdown over the distinct patients each doctor has seen
+    int doctor_count = 0;
+    CohortDoctor *doctors = NULL;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT doctor_id, full_name FROM doctors ORDER BY doctor_id;", -1, &stmt, NULL) == SQLITE_OK) {
+        int capacity = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            if (doctor_count == capacity) {
+                capacity = capacity ? capacity * 2 : 32;
+                CohortDoctor *grown = realloc(doctors, capacity * sizeof(CohortDoctor));
+                if (!grown) break;
+                doctors = grown;
+            }
+            CohortDoctor *doctor = &doctors[doctor_count++];
+            memset(doctor, 0, sizeof(*doctor));
+            doctor->doctor_id = sqlite3_column_int(stmt, 0);
+            snprintf(doctor->name, sizeof(doctor->name), "%s", (const char *)sqlite3_column_text(stmt, 1));
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (doctor_count > 0 &&
+        sqlite3_prepare_v2(db, "SELECT DISTINCT doctor_id, patient_id FROM appointments ORDER BY doctor_id;", -1, &stmt, NULL) == SQLITE_OK) {
+        int d = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int doctor_id = sqlite3_column_int(stmt, 0);
+            int patient_id = sqlite3_column_int(stmt, 1);
+            while (d < doctor_count && doctors[d].doctor_id < doctor_id) d++;
+            if (d == doctor_count) break;
+            if (doctors[d].doctor_id != doctor_id || patient_id < 0 || patient_id > cols.max_patient_id) continue;
+            int row = cols.row_of_patient[patient_id];
+            if (row < 0) continue;
+
+            CohortDoctor *doctor = &doctors[d];
+            doctor->patients++;
+            doctor->genders[cols.genders[row]]++;
+            if (cols.ages[row] > 0) {
+                doctor->aged++;
+                doctor->age_sum += cols.ages[row];
+            }
+            if (cols.weights[row] > 0) {
+                doctor->weighed++;
+                doctor->weight_sum += cols.weights[row];
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+    clock_t computed = clock();
+
+    // Age histogram in decades
+    int decade_count[COHORT_MAX_AGE / 10 + 1] = {0}, max_decade = 0;
+    for (int age = 1; age <= COHORT_MAX_AGE; age++) decade_count[age / 10] += age_bins[age];
+    for (int i = 0; i <= COHORT_MAX_AGE / 10; i++) if (decade_count[i] > max_decade) max_decade = decade_count[i];
+
+    printf("\nPatients: %d (age recorded: %lld, weight recorded: %lld)\n", cols.count, aged, weighed);
+    printf("\nAge distribution\n");
+    for (int i = 0; i <= COHORT_MAX_AGE / 10; i++) {
+        if (decade_count[i] == 0) continue;
+        char label[16];
+        snprintf(label, sizeof(label), "%d-%d", i * 10, i * 10 + 9);
+        print_histogram_bar(label, decade_count[i], max_decade);
+    }
+
+    // Weight histogram in 10 kg bands
+    int band_count[COHORT_WEIGHT_BANDS] = {0}, max_band = 0;
+    for (int bin = 1; bin < COHORT_WEIGHT_BINS; bin++) {
+        int band = bin / (10 * COHORT_WEIGHT_BINS_PER_KG);
+        band_count[band < COHORT_WEIGHT_BANDS ? band : COHORT_WEIGHT_BANDS - 1] += weight_bins[bin];
+    }
+    for (int i = 0; i < COHORT_WEIGHT_BANDS; i++) if (band_count[i] > max_band) max_band = band_count[i];
+
+    printf("\nWeight distribution (kg)\n");
+    for (int i = 0; i < COHORT_WEIGHT_BANDS; i++) {
+        if (band_count[i] == 0) continue;
+        char label[16];
+        if (i == COHORT_WEIGHT_BANDS - 1) snprintf(label, sizeof(label), "%d+", i * 10);
+        else snprintf(label, sizeof(label), "%d-%d", i * 10, i * 10 + 9);
+        print_histogram_bar(label, band_count[i], max_band);
+    }
+
+    static const double fractions[] = {0.10, 0.25, 0.50, 0.75, 0.90};
+    printf("\n%-12s %8s %8s %8s %8s %8s\n", "Percentile", "P10", "P25", "P50", "P75", "P90");
+    if (aged > 0) {
+        printf("%-12s", "Age");
+        for (int i = 0; i < 5; i++) printf(" %8d", histogram_percentile(age_bins, COHORT_MAX_AGE + 1, aged, fractions[i]));
+        printf("\n");
+    }
+    if (weighed > 0) {
+        printf("%-12s", "Weight (kg)");
+        for (int i = 0; i < 5; i++) {
+            printf(" %8.1f", (double)histogram_percentile(weight_bins, COHORT_WEIGHT_BINS, weighed, fractions[i]) / COHORT_WEIGHT_BINS_PER_KG);
+        }
+        printf("\n");
+    }
+
+    printf("\n%-10s %10s %10s %12s\n", "Gender", "Patients", "Mean Age", "Mean Weight");
+    for (int g = 0; g < COHORT_GENDERS; g++) {
+        if (gender_count[g] == 0) continue;
+        printf("%-10s %10d %10.1f %12.1f\n", gender_names[g], gender_count[g],
+               gender_aged[g] ? gender_age_sum[g] / gender_aged[g] : 0.0,
+               gender_weighed[g] ? gender_weight_sum[g] / gender_weighed[g] : 0.0);
+    }
+
+    printf("\n%-5s %-25s %9s %9s %11s %6s %6s %6s\n", "ID", "Doctor", "Patients", "Mean Age", "Mean Weight", "M", "F", "O");
+    for (int d = 0; d < doctor_count; d++) {
+        CohortDoctor *doctor = &doctors[d];
+        if (doctor->patients == 0) continue;
+        printf("%-5d %-25s %9d %9.1f %11.1f %6d %6d %6d\n", doctor->doctor_id, doctor->name, doctor->patients,
+               doctor->aged ? doctor->age_sum / doctor->aged : 0.0,
+               doctor->weighed ? doctor->weight_sum / doctor->weighed : 0.0,
+               doctor->genders[0], doctor->genders[1], doctor->genders[2]);
+    }
+
+    printf("\nLoaded in %.3f s, computed in %.3f s.\n",
+           (double)(loaded - started) / CLOCKS_PER_SEC, (double)(computed - loaded) / CLOCKS_PER_SEC);
+
+    free(doctors);
+    free(age_bins);
+    free(weight_bins);
+    free_patient_columns(&cols);
+    wait_for_enter();
+}
+
+// Weekly Calendar
+//
+// Shows one doctor's (or one specialization's) week as a grid: days across,
+// 15-minute slots from 09:00 to 17:00 down. A window of several weeks around
+// the requested one is fetched with a single range query on the
+// (doctor_id, appointment_date) index and kept in memory; paging to the next
+// or previous week is served from it and only goes back to the database once
+// it leaves the window. Each week is laid into a fixed grid and written with
+// one fwrite.
+int load_calendar_window(CalendarView *view, int first_day) {
+    char from_date[11], to_date[11];
+    int y, m, d;
+    sqlite3_stmt *stmt;
+
+    civil_from_days(first_day, &y, &m, &d);
+    snprintf(from_date, sizeof(from_date), "%04d-%02d-%02d", y, m, d);
+    civil_from_days(first_day + CALENDAR_WINDOW_WEEKS * 7 - 1, &y, &m, &d);
+    snprintf(to_date, sizeof(to_date), "%04d-%02d-%02d", y, m, d);
+
+    const char *sql = view->doctor_id > 0
+        ? "SELECT a.appointment_date, a.appointment_time, a.duration_minutes, p.full_name "
+          "FROM appointments a JOIN patients p ON p.patient_id = a.patient_id "
+          "WHERE a.doctor_id = ?1 AND a.appointment_date BETWEEN ?2 AND ?3;"
+        : "SELECT a.appointment_date, a.appointment_time, a.duration_minutes, p.full_name "
+          "FROM doctors d "
+          "JOIN appointments a ON a.doctor_id = d.doctor_id AND a.appointment_date BETWEEN ?2 AND ?3 "
+          "JOIN patients p ON p.patient_id = a.patient_id "
+          "WHERE d.specialization_id = ?1;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    sqlite3_bind_int(stmt, 1, view->doctor_id > 0 ? view->doctor_id : view->specialization_id);
+    sqlite3_bind_text(stmt, 2, from_date, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, to_date, -1, SQLITE_STATIC);
+
+    view->first_day = first_day;
+    view->count = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int day, hour, minute;
+        if (!parse_date((const char *)sqlite3_column_text(stmt, 0), &day) ||
+            sscanf((const char *)sqlite3_column_text(stmt, 1), "%d:%d", &hour, &minute) != 2) {
+            continue;
+        }
+        if (view->count == view->capacity) {
+            int capacity = view->capacity ? view->capacity * 2 : 256;
+            CalendarEntry *grown = realloc(view->entries, capacity * sizeof(CalendarEntry));
+            if (!grown) break;
+            view->entries = grown;
+            view->capacity = capacity;
+        }
+        CalendarEntry *entry = &view->entries[view->count++];
+        entry->day = day;
+        entry->start_minute = hour * 60 + minute;
+        entry->duration_minutes = sqlite3_column_int(stmt, 2);
+        snprintf(entry->patient, sizeof(entry->patient), "%s", (const char *)sqlite3_column_text(stmt, 3));
+    }
+    sqlite3_finalize(stmt);
+    return 1;
+}
+
+void render_calendar_week(const CalendarView *view, int week_day) {
+    static const char *day_names[7] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+    // Per cell: appointments covering the slot, and the first one starting in it
+    int covering[7][SCHEDULE_SLOTS_PER_DAY] = {{0}};
+    int starting[7][SCHEDULE_SLOTS_PER_DAY];
+    int outside_hours = 0, total = 0;
+    char buffer[CALENDAR_BUFFER_SIZE];
+    int len = 0, y, m, d;
+
+    memset(starting, -1, sizeof(starting));
+    for (int i = 0; i < view->count; i++) {
+        const CalendarEntry *entry = &view->entries[i];
+        int wd = entry->day - week_day;
+        if (wd < 0 || wd >= 7) continue;
+        total++;
+
+        int start = entry->start_minute - SCHEDULE_DAY_START;
+        int end = start + entry->duration_minutes;
+        if (start < 0 || end > SCHEDULE_SLOTS_PER_DAY * SCHEDULE_SLOT_MINUTES) outside_hours++;
+        int first_slot = start < 0 ? 0 : start / SCHEDULE_SLOT_MINUTES;
+        int last_slot = (end + SCHEDULE_SLOT_MINUTES - 1) / SCHEDULE_SLOT_MINUTES;
+        if (last_slot > SCHEDULE_SLOTS_PER_DAY) last_slot = SCHEDULE_SLOTS_PER_DAY;
+        for (int slot = first_slot; slot < last_slot; slot++) covering[wd][slot]++;
+        if (first_slot < last_slot && starting[wd][first_slot] < 0) starting[wd][first_slot] = i;
+    }
+
+    civil_from_days(week_day, &y, &m, &d);
+    len += snprintf(buffer + len, sizeof(buffer) - len, "\n=== %s: week of %04d-%02d-%02d ===\n\n%-6s",
+                    view->title, y, m, d, "Time");
+    for (int wd = 0; wd < 7; wd++) {
+        civil_from_days(week_day + wd, &y, &m, &d);
+        char header[16];
+        snprintf(header, sizeof(header), "%s %02d/%02d", day_names[wd], d, m);
+        len += snprintf(buffer + len, sizeof(buffer) - len, "|%-*s", CALENDAR_CELL_WIDTH, header);
+    }
+    len += snprintf(buffer + len, sizeof(buffer) - len, "\n");
+
+    for (int slot = 0; slot < SCHEDULE_SLOTS_PER_DAY; slot++) {
+        int minute = slot_start_minute(slot);
+        len += snprintf(buffer + len, sizeof(buffer) - len, "%02d:%02d ", minute / 60, minute % 60);
+        for (int wd = 0; wd < 7; wd++) {
+            char cell[64] = "";
+            if (covering[wd][slot] > 1) {
+                snprintf(cell, sizeof(cell), "[%d booked]", covering[wd][slot]);
+            } else if (starting[wd][slot] >= 0) {
+                snprintf(cell, sizeof(cell), "%s", view->entries[starting[wd][slot]].patient);
+            } else if (covering[wd][slot] == 1) {
+                snprintf(cell, sizeof(cell), "  ...");
+            }
+            len += snprintf(buffer + len, sizeof(buffer) - len, "|%-*.*s", CALENDAR_CELL_WIDTH, CALENDAR_CELL_WIDTH, cell);
+        }
+        len += snprintf(buffer + len, sizeof(buffer) - len, "\n");
+    }
+    len += snprintf(buffer + len, sizeof(buffer) - len, "\n%d appointment(s) this week", total);
+    if (outside_hours > 0) {
+        len += snprintf(buffer + len, sizeof(buffer) - len, ", %d outside 09:00-17:00", outside_hours);
+    }
+    len += snprintf(buffer + len, sizeof(buffer) - len, ".\n");
+
+    fwrite(buffer, 1, len < (int)sizeof(buffer) ? len : (int)sizeof(buffer) - 1, stdout);
+    fflush(stdout);
+}
+
+void view_calendar() {
+    CalendarView view;
+    char doctor_id[16], specialization[100], date[16], command[16];
+    int day;
+
+    memset(&view, 0, sizeof(view));
+    printf("\n=== WEEKLY CALENDAR ===\n");
+    get_input(doctor_id, "Doctor ID (Enter to view a specialization): ");
+    view.doctor_id = atoi(doctor_id);
+    if (view.doctor_id > 0) {
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(db, "SELECT full_name FROM doctors WHERE doctor_id = ?;", -1, &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_int(stmt, 1, view.doctor_id);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                snprintf(view.title, sizeof(view.title), "%s", (const char *)sqlite3_column_text(stmt, 0));
+            }
+            sqlite3_finalize(stmt);
+        }
+        if (view.title[0] == '\0') {
+            printf("Doctor %d does not exist.\n", view.doctor_id);
+            wait_for_enter();
+            return;
+        }
+    } else {
+        get_input(specialization, "Specialization: ");
+        view.specialization_id = find_specialization(specialization);
+        if (view.specialization_id == 0) {
+            printf("Unknown specialization: %s\n", specialization);
+            wait_for_enter();
+            return;
+        }
+        snprintf(view.title, sizeof(view.title), "%s", specialization_name(view.specialization_id));
+    }
+
+    get_input(date, "Week containing (YYYY-MM-DD, Enter for this week): ");
+    if (!parse_date(date, &day)) {
+        time_t now = time(NULL);
+        struct tm *local = localtime(&now);
+        day = days_from_civil(local->tm_year + 1900, local->tm_mon + 1, local->tm_mday);
+    }
+    // 1970-01-01 was a Thursday; weeks start on Monday
+    int week_day = day - ((day % 7 + 10) % 7);
+
+    view.first_day = INT_MIN / 2;
+    while (1) {
+        int last_day = view.first_day + CALENDAR_WINDOW_WEEKS * 7;
+        if (week_day < view.first_day || week_day + 7 > last_day) {
+            // Keep the requested week in the middle of the loaded window
+            if (!load_calendar_window(&view, week_day - (CALENDAR_WINDOW_WEEKS / 2) * 7)) break;
+        }
+        clear_screen();
+        render_calendar_week(&view, week_day);
+
+        get_input(command, "\n[n]ext week, [p]revious week, [q]uit: ");
+        if (command[0] == 'n' || command[0] == 'N') {
+            week_day += 7;
+        } else if (command[0] == 'p' || command[0] == 'P') {
+            week_day -= 7;
+        } else if (command[0] == 'q' || command[0] == 'Q') {
+            break;
+        }
+    }
+    free(view.entries);
+}
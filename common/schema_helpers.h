@@ -0,0 +1,41 @@
+// Schema Helpers
+//
+// Migration helpers shared by the single-file programs that open a clinic
+// database: CAMS/app.c, CAMS/main.c and appointment/appointment.c.
+#ifndef SCHEMA_HELPERS_H
+#define SCHEMA_HELPERS_H
+
+#include <stdio.h>
+#include <sqlite3.h>
+
+// Returns 1 if the table has a column with this name
+static int column_exists(sqlite3 *db, const char *table, const char *column) {
+    sqlite3_stmt *stmt;
+    int exists = 0;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM pragma_table_info(?) WHERE name = ?;", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, column, -1, SQLITE_STATIC);
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+    return exists;
+}
+
+// Runs the statements as one transaction. On any error the transaction is
+// rolled back, so the connection is never left inside it. Returns 0 on
+// success, -1 on failure.
+static int run_migration(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+
+    if (sqlite3_exec(db, "BEGIN;", 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, sql, 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, "COMMIT;", 0, 0, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "Migration failed: %s\n", err_msg ? err_msg : sqlite3_errmsg(db));
+        sqlite3_free(err_msg);
+        if (!sqlite3_get_autocommit(db)) sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        return -1;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,124 @@
+// Specialization Cache
+//
+// In-process copy of the specializations table, shared by CAMS/app.c and
+// appointment/appointment.c. It is loaded once at startup into a hash
+// table keyed by name and an array indexed by ID. Names match
+// case-insensitively, like the table's NOCASE collation. After loading,
+// resolving a typed name or printing a doctor's specialization needs no
+// query. Uses the including program's global db connection.
+#ifndef SPECIALIZATION_CACHE_H
+#define SPECIALIZATION_CACHE_H
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sqlite3.h>
+
+extern sqlite3 *db;
+
+typedef struct {
+    int id;
+    char *name;
+} Specialization;
+
+static struct {
+    Specialization *entries;
+    int count, capacity;
+    int *slots;      // Open addressing: entry index + 1, 0 = empty
+    int slot_count;  // Power of two
+    int *by_id;      // specialization_id -> entry index + 1
+    int id_capacity;
+} specializations;
+
+// FNV-1a over the upper-cased name
+static unsigned int specialization_hash(const char *name) {
+    unsigned int hash = 2166136261u;
+    for (; *name; name++) {
+        hash ^= (unsigned char)toupper((unsigned char)*name);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Slot holding the name, or the empty slot where it would go
+static int specialization_slot(const char *name) {
+    unsigned int mask = specializations.slot_count - 1;
+    unsigned int i = specialization_hash(name) & mask;
+    while (specializations.slots[i] &&
+           strcasecmp(specializations.entries[specializations.slots[i] - 1].name, name) != 0) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+// Adds an entry, growing the tables as needed. Returns the ID, or -1 when out of memory.
+static int cache_specialization(int id, const char *name) {
+    if ((specializations.count + 1) * 2 > specializations.slot_count) {
+        int slot_count = specializations.slot_count ? specializations.slot_count * 2 : 64;
+        int *slots = calloc(slot_count, sizeof(int));
+        if (!slots) return -1;
+        free(specializations.slots);
+        specializations.slots = slots;
+        specializations.slot_count = slot_count;
+        for (int i = 0; i < specializations.count; i++) {
+            specializations.slots[specialization_slot(specializations.entries[i].name)] = i + 1;
+        }
+    }
+    if (specializations.count == specializations.capacity) {
+        int capacity = specializations.capacity ? specializations.capacity * 2 : 32;
+        Specialization *grown = realloc(specializations.entries, capacity * sizeof(Specialization));
+        if (!grown) return -1;
+        specializations.entries = grown;
+        specializations.capacity = capacity;
+    }
+    if (id >= specializations.id_capacity) {
+        int capacity = specializations.id_capacity ? specializations.id_capacity : 32;
+        while (capacity <= id) capacity *= 2;
+        int *grown = realloc(specializations.by_id, capacity * sizeof(int));
+        if (!grown) return -1;
+        memset(grown + specializations.id_capacity, 0, (capacity - specializations.id_capacity) * sizeof(int));
+        specializations.by_id = grown;
+        specializations.id_capacity = capacity;
+    }
+
+    Specialization *entry = &specializations.entries[specializations.count];
+    entry->id = id;
+    entry->name = malloc(strlen(name) + 1);
+    if (!entry->name) return -1;
+    strcpy(entry->name, name);
+
+    specializations.slots[specialization_slot(name)] = specializations.count + 1;
+    specializations.by_id[id] = specializations.count + 1;
+    specializations.count++;
+    return id;
+}
+
+// Fills the cache from the specializations table
+static void load_specializations() {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT specialization_id, name FROM specializations ORDER BY name;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to load specializations: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        cache_specialization(sqlite3_column_int(stmt, 0), (const char *)sqlite3_column_text(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+}
+
+// ID of the specialization with this name (any case), or 0 if there is none
+static int find_specialization(const char *name) {
+    if (specializations.slot_count == 0) return 0;
+    int entry = specializations.slots[specialization_slot(name)];
+    return entry ? specializations.entries[entry - 1].id : 0;
+}
+
+// Name for an ID, or "-" for an unknown one
+static const char *specialization_name(int id) {
+    if (id <= 0 || id >= specializations.id_capacity || !specializations.by_id[id]) return "-";
+    return specializations.entries[specializations.by_id[id] - 1].name;
+}
+
+#endif
@@ -10,15 +10,35 @@
 #include <sqlite3.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
 
 // Function Prototypes
 void clearScreen();
 void waitForEnter();
 void initializeDatabase(sqlite3 *db);
+int tableExists(sqlite3 *db, const char *name);
+int columnExists(sqlite3 *db, const char *table, const char *column);
 void showMainMenu(sqlite3 *db);
 void propertyMenu(sqlite3 *db);
 void flatManagementMenu(sqlite3 *db);
 
+// Function prototypes for flat management
+void addNewFlat(sqlite3 *db);
+void viewAllFlats(sqlite3 *db);
+void editFlat(sqlite3 *db);
+void deleteFlat(sqlite3 *db);
+void assignRoomsToFlat(sqlite3 *db);
+
+// Function prototypes for the property hierarchy
+void propertyTreeMenu(sqlite3 *db);
+void addBuilding(sqlite3 *db);
+void addFloor(sqlite3 *db);
+void placeFlatOnFloor(sqlite3 *db);
+void viewPropertyTree(sqlite3 *db);
+void unitsUnderNode(sqlite3 *db);
+
 // Function prototypes for room management
 void roomManagementMenu(sqlite3 *db);
 void addNewRoom(sqlite3 *db);
@@ -26,6 +46,233 @@ void viewAllRooms(sqlite3 *db);
 void editRoom(sqlite3 *db);
 void deleteRoom(sqlite3 *db);
 
+// Function prototypes for tenant management
+void tenantManagementMenu(sqlite3 *db);
+void addTenant(sqlite3 *db);
+void viewTenants(sqlite3 *db);
+void startTenancy(sqlite3 *db);
+void endTenancy(sqlite3 *db);
+void viewActiveTenancies(sqlite3 *db);
+void unitOccupantOnDate(sqlite3 *db);
+void vacantUnitsToday(sqlite3 *db);
+void monthlyOccupancyRate(sqlite3 *db);
+void upcomingLeaseEvents(sqlite3 *db);
+void scheduleRentReview(sqlite3 *db);
+void showLeaseAlerts(sqlite3 *db);
+
+// Function prototypes for rent and utility management
+void rentUtilityMenu(sqlite3 *db);
+void runMonthlyBilling(sqlite3 *db);
+void viewInvoicesForPeriod(sqlite3 *db);
+void recordPayment(sqlite3 *db);
+void addMeter(sqlite3 *db);
+void recordMeterReading(sqlite3 *db);
+void viewMeterReadings(sqlite3 *db);
+void unitUtilityConsumption(sqlite3 *db);
+void editLateFeeRules(sqlite3 *db);
+void reconcileBankTransactions(sqlite3 *db);
+void generateReceipts(sqlite3 *db);
+
+// Function prototypes for reports
+void reportsMenu(sqlite3 *db);
+void utilityConsumptionReport(sqlite3 *db);
+void arrearsReport(sqlite3 *db);
+
+// Function prototypes for data export
+void dataExportMenu(sqlite3 *db);
+void exportAllTables(sqlite3 *db);
+void exportChanges(sqlite3 *db);
+
+// Tenancy intervals
+//
+// Every tenancy is a [start_date, end_date] interval on one unit, either a
+// flat or a room. The tenancy_intervals R*Tree mirrors the tenancies table
+// through triggers, so "who was in unit X on day D", "which units are vacant"
+// and monthly occupancy are answered with window queries instead of scans
+// over the whole tenancy history. Units are keyed as id*2 for flats and
+// id*2+1 for rooms, days are julian day numbers, and a tenancy without an
+// end date runs to OPEN_END_DAY.
+#define UNIT_FLAT 0
+#define UNIT_ROOM 1
+#define OPEN_END_DAY 9999999
+#define DATE_SIZE 11
+
+// Lease events
+//
+// lease_events holds the dated obligations that come out of each tenancy:
+// its end, the next rent review, and the deadline for returning a deposit
+// (DEPOSIT_RETURN_DAYS after the end). Triggers on tenancies rebuild a
+// tenancy's events whenever its end date, deposit or review date changes,
+// so the calendar and the startup banner are a range scan on
+// idx_lease_events_due and never look at the tenancies themselves.
+#define LEASE_EVENT_WINDOW_DAYS 30
+#define DEPOSIT_RETURN_DAYS 30
+
+// CSV export
+//
+// Each table is streamed from a stepped statement into a fixed-size buffer
+// that is written out with one fwrite whenever it fills, so memory use is
+// EXPORT_BUFFER_SIZE however large the table is. Fields follow RFC 4180:
+// CRLF record separators, and fields holding a comma, quote, CR or LF are
+// quoted with embedded quotes doubled. NULL is exported as an empty field.
+// Files are written under a temporary name and renamed once complete.
+//
+// Incremental exports rely on change tracking in every exported table: an
+// updated_at column (UTC, millisecond precision) stamped by triggers on
+// insert (unless the insert supplies it) and update, and a row in
+// export_tombstones for each delete. export_watermarks remembers, per table,
+// the (updated_at, id) of the newest row already exported and the last
+// tombstone sequence number.
+#define EXPORT_BUFFER_SIZE (1 << 20)
+#define EXPORT_PATH_SIZE 512
+
+typedef struct {
+    FILE *fp;
+    char *data;
+    size_t used;
+    long long bytes;
+    int failed;
+} CsvWriter;
+
+// Input helpers shared by the menus
+static void promptLine(const char *prompt, char *buf, int size);
+static int promptDate(const char *prompt, char *buf, int allow_blank);
+static void todayDate(char *buf);
+
+// Property hierarchy
+//
+// property_nodes holds the building -> floor -> flat -> room tree; every flat
+// and room row has a node, created and renamed by triggers on those tables.
+// property_closure stores one row per (ancestor, descendant) pair, including
+// each node paired with itself at depth 0, so "everything under floor 3" is a
+// single range scan on the closure primary key at any depth. Triggers keep
+// the closure in step when nodes are added, moved or deleted; deleting a node
+// moves its children up to its parent.
+
+// Billing
+//
+// A billing run issues one rent invoice per tenancy that overlaps the period
+// (a calendar month, YYYY-MM). Tenancies that start or end inside the month
+// are charged pro rata by the days they cover. UNIQUE(tenancy_id, period)
+// makes the run idempotent: running the same period again only fills in
+// invoices for tenancies added since, and never duplicates one.
+#define PERIOD_SIZE 8
+#define INVOICE_DUE_DAYS 7
+
+// Arrears
+//
+// Payments are credited to a tenancy's invoices oldest first, whichever
+// invoice they were recorded against. The engine walks invoices sorted by
+// (tenancy, period) alongside per-tenancy payment totals sorted the same
+// way, so every invoice is visited once. Late fees follow the single row in
+// late_fee_rules: nothing within grace_days of the due date, then flat_fee
+// plus monthly_rate percent of the unpaid amount for every started 30 days
+// overdue, capped at max_fee when that is non-zero.
+#define ARREARS_BUCKETS 5
+#define ARREARS_TOP 25
+
+typedef struct {
+    int tenancy_id;
+    double outstanding;
+    double fees;
+    int oldest_days;
+} ArrearsRow;
+
+// Bank reconciliation
+//
+// Tenants quote an invoice's payment reference, RK followed by the invoice
+// id in seven digits (the format TransactionManager in email.py records in
+// email_records.db). Reconciliation attaches that database, loads the
+// month's bank transactions into an open-addressing hash table keyed by the
+// invoice id in their reference, then streams every outstanding invoice once
+// and probes the table. A probe hit is a match when the transaction is dated
+// no more than RECONCILE_EARLY_DAYS before the invoice was issued and, when
+// the transactions table has an amount column, the amount is within
+// RECONCILE_TOLERANCE of the invoice balance. Matched transactions can then
+// be posted as payments carrying the bank reference, which keeps a re-run
+// from posting them twice: already posted transactions are set aside when
+// the table is built.
+#define REF_SIZE 16
+#define BANK_NAME_SIZE 48
+#define RECONCILE_EARLY_DAYS 10
+#define RECONCILE_TOLERANCE 0.01
+#define RECONCILE_LIST_LIMIT 20
+
+typedef struct {
+    int invoice_id;          // 0 marks an empty slot
+    char ref[REF_SIZE];
+    char bank[BANK_NAME_SIZE];
+    char date[DATE_SIZE];
+    int day;
+    double amount;
+    int has_amount;
+    int status;              // One of the RECONCILE_* states below
+    double balance;          // Invoice balance, once matched
+} BankTransaction;
+
+enum {
+    RECONCILE_UNMATCHED,
+    RECONCILE_MATCHED,
+    RECONCILE_TOO_EARLY,
+    RECONCILE_AMOUNT_DIFFERS,
+    RECONCILE_POSTED
+};
+
+// Receipts
+//
+// A receipt batch reads the month's payments once, in the main thread, then
+// hands them to a pool of worker threads (one per core, at most
+// RECEIPT_MAX_THREADS). Workers never touch the database: each claims the
+// next payment from a shared counter, renders it from the template into its
+// own buffer and writes the file with a single fwrite to a temporary name
+// that is renamed into place. Receipts whose file already exists are
+// skipped, so an interrupted or repeated run only fills in what is missing.
+// Templates use {{placeholders}}; values are HTML-escaped for HTML output.
+#define RECEIPT_MAX_THREADS 16
+#define RECEIPT_BUFFER_SIZE (16 * 1024)
+#define RECEIPT_TEMPLATE_SIZE (12 * 1024)
+
+typedef struct {
+    int payment_id;
+    int invoice_id;
+    char tenant[100];
+    char unit[64];
+    char period[PERIOD_SIZE];
+    char paid_on[DATE_SIZE];
+    char method[48];
+    char reference[16];
+    double amount;
+    double invoice_amount;
+} Receipt;
+
+typedef struct {
+    const Receipt *receipts;
+    int count;
+    int next;                 // Next receipt to claim, guarded by lock
+    pthread_mutex_t lock;
+    const char *template_text;
+    int html;
+    const char *directory;
+    const char *extension;
+} ReceiptBatch;
+
+typedef struct {
+    ReceiptBatch *batch;
+    int written;
+    int skipped;
+    int failed;
+} ReceiptWorker;
+
+// Utility meters
+//
+// Each meter belongs to one flat or room. meter_readings is keyed by
+// (meter_id, reading_date) and stores the consumption since the previous
+// reading of the same meter. Triggers fill in that consumption, repair the
+// following reading when one is inserted, corrected or deleted out of order,
+// and fold every change into utility_rollups, a per-unit, per-utility,
+// per-month total. Bills and reports read the rollups and never walk the
+// reading history.
+
 // Helper function to clear the input buffer
 void clearInputBuffer() {
     int c;
@@ -43,6 +290,7 @@ int main() {
 
     // Initialize the database with tables
     initializeDatabase(db);
+    showLeaseAlerts(db);
 
     // Main menu loop
     while (1) {
@@ -90,6 +338,412 @@ void initializeDatabase(sqlite3 *db) {
         fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
         return; // Stop further execution if there is an error
     }
+
+    // Tenants and their tenancies; end_date is inclusive and NULL while the
+    // tenancy is still running
+    const char *create_tenancies = "CREATE TABLE IF NOT EXISTS tenants ("
+                                   "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                   "name TEXT NOT NULL,"
+                                   "phone TEXT,"
+                                   "email TEXT);"
+                                   "CREATE TABLE IF NOT EXISTS tenancies ("
+                                   "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                   "tenant_id INTEGER NOT NULL REFERENCES tenants(id),"
+                                   "unit_type TEXT NOT NULL CHECK (unit_type IN ('flat', 'room')),"
+                                   "unit_id INTEGER NOT NULL,"
+                                   "start_date TEXT NOT NULL,"
+                                   "end_date TEXT,"
+                                   "monthly_rent REAL NOT NULL DEFAULT 0,"
+                                   "CHECK (end_date IS NULL OR end_date >= start_date));"
+                                   "CREATE INDEX IF NOT EXISTS idx_tenancies_tenant ON tenancies(tenant_id);"
+                                   "CREATE INDEX IF NOT EXISTS idx_tenancies_unit ON tenancies(unit_type, unit_id, start_date);";
+
+    rc = sqlite3_exec(db, create_tenancies, 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    // The interval index is rebuilt from tenancies the first time it is
+    // created; afterwards the triggers keep it in step with every change
+    int backfill = !tableExists(db, "tenancy_intervals");
+    const char *create_intervals = "CREATE VIRTUAL TABLE IF NOT EXISTS tenancy_intervals USING rtree_i32("
+                                   "id, unit_lo, unit_hi, start_day, end_day);"
+                                   "CREATE TRIGGER IF NOT EXISTS tenancies_interval_insert AFTER INSERT ON tenancies BEGIN "
+                                   "INSERT INTO tenancy_intervals VALUES (NEW.id,"
+                                   " NEW.unit_id * 2 + (NEW.unit_type = 'room'), NEW.unit_id * 2 + (NEW.unit_type = 'room'),"
+                                   " CAST(julianday(NEW.start_date) AS INTEGER),"
+                                   " COALESCE(CAST(julianday(NEW.end_date) AS INTEGER), 9999999)); END;"
+                                   "CREATE TRIGGER IF NOT EXISTS tenancies_interval_update"
+                                   " AFTER UPDATE OF unit_type, unit_id, start_date, end_date ON tenancies BEGIN "
+                                   "INSERT OR REPLACE INTO tenancy_intervals VALUES (NEW.id,"
+                                   " NEW.unit_id * 2 + (NEW.unit_type = 'room'), NEW.unit_id * 2 + (NEW.unit_type = 'room'),"
+                                   " CAST(julianday(NEW.start_date) AS INTEGER),"
+                                   " COALESCE(CAST(julianday(NEW.end_date) AS INTEGER), 9999999)); END;"
+                                   "CREATE TRIGGER IF NOT EXISTS tenancies_interval_delete AFTER DELETE ON tenancies BEGIN "
+                                   "DELETE FROM tenancy_intervals WHERE id = OLD.id; END;";
+
+    rc = sqlite3_exec(db, create_intervals, 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    // Deposits and rent reviews were added after the first tenancies
+    if (!columnExists(db, "tenancies", "deposit")) {
+        rc = sqlite3_exec(db, "ALTER TABLE tenancies ADD COLUMN deposit REAL NOT NULL DEFAULT 0;", 0, 0, 0);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            return;
+        }
+    }
+    if (!columnExists(db, "tenancies", "rent_review_date")) {
+        rc = sqlite3_exec(db, "ALTER TABLE tenancies ADD COLUMN rent_review_date TEXT;", 0, 0, 0);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            return;
+        }
+    }
+
+    // Lease events are derived from tenancies: rebuilt from scratch the first
+    // time the table is created, then kept current by the triggers
+    int backfill_events = !tableExists(db, "lease_events");
+    const char *event_rows = "SELECT %1$s.id, 'lease_end', %1$s.end_date%3$s WHERE %1$s.end_date IS NOT NULL"
+                             " UNION ALL SELECT %1$s.id, 'deposit_return', date(%1$s.end_date, '+%2$d days')%3$s"
+                             " WHERE %1$s.end_date IS NOT NULL AND %1$s.deposit > 0"
+                             " UNION ALL SELECT %1$s.id, 'rent_review', %1$s.rent_review_date%3$s"
+                             " WHERE %1$s.rent_review_date IS NOT NULL"
+                             " AND (%1$s.end_date IS NULL OR %1$s.rent_review_date <= %1$s.end_date)";
+    char new_events[1024];
+    char create_events[4096];
+    snprintf(new_events, sizeof(new_events), event_rows, "NEW", DEPOSIT_RETURN_DAYS, "");
+    snprintf(create_events, sizeof(create_events),
+             "CREATE TABLE IF NOT EXISTS lease_events ("
+             "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+             "tenancy_id INTEGER NOT NULL REFERENCES tenancies(id),"
+             "event_type TEXT NOT NULL CHECK (event_type IN ('lease_end', 'rent_review', 'deposit_return')),"
+             "due_date TEXT NOT NULL,"
+             "UNIQUE (tenancy_id, event_type));"
+             "CREATE INDEX IF NOT EXISTS idx_lease_events_due ON lease_events(due_date);"
+             "CREATE TRIGGER IF NOT EXISTS tenancies_events_insert AFTER INSERT ON tenancies BEGIN "
+             "INSERT INTO lease_events (tenancy_id, event_type, due_date) %s; END;"
+             "CREATE TRIGGER IF NOT EXISTS tenancies_events_update"
+             " AFTER UPDATE OF end_date, deposit, rent_review_date ON tenancies BEGIN "
+             "DELETE FROM lease_events WHERE tenancy_id = NEW.id;"
+             "INSERT INTO lease_events (tenancy_id, event_type, due_date) %s; END;"
+             "CREATE TRIGGER IF NOT EXISTS tenancies_events_delete AFTER DELETE ON tenancies BEGIN "
+             "DELETE FROM lease_events WHERE tenancy_id = OLD.id; END;",
+             new_events, new_events);
+
+    rc = sqlite3_exec(db, create_events, 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    if (backfill_events) {
+        char rows[1024];
+        char sql[1200];
+        snprintf(rows, sizeof(rows), event_rows, "t", DEPOSIT_RETURN_DAYS, " FROM tenancies t");
+        snprintf(sql, sizeof(sql), "INSERT INTO lease_events (tenancy_id, event_type, due_date) %s;", rows);
+        rc = sqlite3_exec(db, sql, 0, 0, 0);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            return;
+        }
+    }
+
+    // Rent invoices and the payments made against them
+    const char *create_billing = "CREATE TABLE IF NOT EXISTS invoices ("
+                                 "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                 "tenancy_id INTEGER NOT NULL REFERENCES tenancies(id),"
+                                 "period TEXT NOT NULL,"
+                                 "issue_date TEXT NOT NULL,"
+                                 "due_date TEXT NOT NULL,"
+                                 "amount REAL NOT NULL,"
+                                 "UNIQUE (tenancy_id, period));"
+                                 "CREATE INDEX IF NOT EXISTS idx_invoices_period ON invoices(period);"
+                                 "CREATE TABLE IF NOT EXISTS payments ("
+                                 "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                 "invoice_id INTEGER NOT NULL REFERENCES invoices(id),"
+                                 "amount REAL NOT NULL CHECK (amount > 0),"
+                                 "paid_on TEXT NOT NULL,"
+                                 "method TEXT);"
+                                 "CREATE INDEX IF NOT EXISTS idx_payments_invoice ON payments(invoice_id);";
+
+    rc = sqlite3_exec(db, create_billing, 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    // Payments posted from a bank transaction carry its reference
+    if (!columnExists(db, "payments", "reference")) {
+        rc = sqlite3_exec(db, "ALTER TABLE payments ADD COLUMN reference TEXT;", 0, 0, 0);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            return;
+        }
+    }
+    rc = sqlite3_exec(db, "CREATE UNIQUE INDEX IF NOT EXISTS idx_payments_reference"
+                          " ON payments(reference) WHERE reference IS NOT NULL;"
+                          "CREATE INDEX IF NOT EXISTS idx_payments_paid_on ON payments(paid_on);", 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    // Late fee rules, a single row seeded with the defaults
+    const char *create_late_fees = "CREATE TABLE IF NOT EXISTS late_fee_rules ("
+                                   "id INTEGER PRIMARY KEY CHECK (id = 1),"
+                                   "grace_days INTEGER NOT NULL,"
+                                   "flat_fee REAL NOT NULL,"
+                                   "monthly_rate REAL NOT NULL,"
+                                   "max_fee REAL NOT NULL);"
+                                   "INSERT OR IGNORE INTO late_fee_rules VALUES (1, 5, 25.0, 1.5, 0);";
+
+    rc = sqlite3_exec(db, create_late_fees, 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    // Meters, their readings and the monthly consumption rollups
+    const char *create_meters = "CREATE TABLE IF NOT EXISTS meters ("
+                                "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                "serial TEXT NOT NULL UNIQUE,"
+                                "utility TEXT NOT NULL CHECK (utility IN ('electricity', 'water')),"
+                                "unit_type TEXT NOT NULL CHECK (unit_type IN ('flat', 'room')),"
+                                "unit_id INTEGER NOT NULL);"
+                                "CREATE INDEX IF NOT EXISTS idx_meters_unit ON meters(unit_type, unit_id);"
+                                "CREATE TABLE IF NOT EXISTS meter_readings ("
+                                "meter_id INTEGER NOT NULL REFERENCES meters(id),"
+                                "reading_date TEXT NOT NULL,"
+                                "value REAL NOT NULL,"
+                                "consumption REAL,"
+                                "PRIMARY KEY (meter_id, reading_date)) WITHOUT ROWID;"
+                                "CREATE TABLE IF NOT EXISTS utility_rollups ("
+                                "unit_type TEXT NOT NULL,"
+                                "unit_id INTEGER NOT NULL,"
+                                "utility TEXT NOT NULL,"
+                                "period TEXT NOT NULL,"
+                                "consumption REAL NOT NULL DEFAULT 0,"
+                                "readings INTEGER NOT NULL DEFAULT 0,"
+                                "PRIMARY KEY (unit_type, unit_id, utility, period)) WITHOUT ROWID;"
+                                "CREATE INDEX IF NOT EXISTS idx_utility_rollups_period ON utility_rollups(period, utility);"
+                                // A new or corrected reading sets its own consumption and the next one's
+                                "CREATE TRIGGER IF NOT EXISTS meter_reading_insert AFTER INSERT ON meter_readings BEGIN "
+                                "UPDATE meter_readings SET consumption = NEW.value - (SELECT value FROM meter_readings"
+                                " WHERE meter_id = NEW.meter_id AND reading_date < NEW.reading_date"
+                                " ORDER BY reading_date DESC LIMIT 1)"
+                                " WHERE meter_id = NEW.meter_id AND reading_date = NEW.reading_date;"
+                                "UPDATE meter_readings SET consumption = value - NEW.value"
+                                " WHERE meter_id = NEW.meter_id AND reading_date = (SELECT MIN(reading_date)"
+                                " FROM meter_readings WHERE meter_id = NEW.meter_id AND reading_date > NEW.reading_date); END;"
+                                "CREATE TRIGGER IF NOT EXISTS meter_reading_value AFTER UPDATE OF value ON meter_readings BEGIN "
+                                "UPDATE meter_readings SET consumption = NEW.value - (SELECT value FROM meter_readings"
+                                " WHERE meter_id = NEW.meter_id AND reading_date < NEW.reading_date"
+                                " ORDER BY reading_date DESC LIMIT 1)"
+                                " WHERE meter_id = NEW.meter_id AND reading_date = NEW.reading_date;"
+                                "UPDATE meter_readings SET consumption = value - NEW.value"
+                                " WHERE meter_id = NEW.meter_id AND reading_date = (SELECT MIN(reading_date)"
+                                " FROM meter_readings WHERE meter_id = NEW.meter_id AND reading_date > NEW.reading_date); END;"
+                                // Removing a reading bridges its neighbours
+                                "CREATE TRIGGER IF NOT EXISTS meter_reading_delete AFTER DELETE ON meter_readings BEGIN "
+                                "INSERT INTO utility_rollups (unit_type, unit_id, utility, period, consumption, readings)"
+                                " SELECT unit_type, unit_id, utility, strftime('%Y-%m', OLD.reading_date),"
+                                " -COALESCE(OLD.consumption, 0), -(OLD.consumption IS NOT NULL)"
+                                " FROM meters WHERE id = OLD.meter_id"
+                                " ON CONFLICT (unit_type, unit_id, utility, period) DO UPDATE SET"
+                                " consumption = consumption + excluded.consumption, readings = readings + excluded.readings;"
+                                "UPDATE meter_readings SET consumption = value - (SELECT value FROM meter_readings"
+                                " WHERE meter_id = OLD.meter_id AND reading_date < OLD.reading_date"
+                                " ORDER BY reading_date DESC LIMIT 1)"
+                                " WHERE meter_id = OLD.meter_id AND reading_date = (SELECT MIN(reading_date)"
+                                " FROM meter_readings WHERE meter_id = OLD.meter_id AND reading_date > OLD.reading_date); END;"
+                                // Every consumption change is applied to the rollup as a delta
+                                "CREATE TRIGGER IF NOT EXISTS meter_reading_rollup AFTER UPDATE OF consumption ON meter_readings"
+                                " WHEN NEW.consumption IS NOT OLD.consumption BEGIN "
+                                "INSERT INTO utility_rollups (unit_type, unit_id, utility, period, consumption, readings)"
+                                " SELECT unit_type, unit_id, utility, strftime('%Y-%m', NEW.reading_date),"
+                                " COALESCE(NEW.consumption, 0) - COALESCE(OLD.consumption, 0),"
+                                " (NEW.consumption IS NOT NULL) - (OLD.consumption IS NOT NULL)"
+                                " FROM meters WHERE id = NEW.meter_id"
+                                " ON CONFLICT (unit_type, unit_id, utility, period) DO UPDATE SET"
+                                " consumption = consumption + excluded.consumption, readings = readings + excluded.readings; END;";
+
+    rc = sqlite3_exec(db, create_meters, 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    // Property tree and its closure table
+    int backfill_nodes = !tableExists(db, "property_nodes");
+    const char *create_tree = "CREATE TABLE IF NOT EXISTS property_nodes ("
+                              "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                              "node_type TEXT NOT NULL CHECK (node_type IN ('building', 'floor', 'flat', 'room')),"
+                              "ref_id INTEGER,"
+                              "name TEXT NOT NULL,"
+                              "parent_id INTEGER REFERENCES property_nodes(id),"
+                              "UNIQUE (node_type, ref_id));"
+                              "CREATE INDEX IF NOT EXISTS idx_property_nodes_parent ON property_nodes(parent_id, node_type, name);"
+                              "CREATE TABLE IF NOT EXISTS property_closure ("
+                              "ancestor INTEGER NOT NULL,"
+                              "descendant INTEGER NOT NULL,"
+                              "depth INTEGER NOT NULL,"
+                              "PRIMARY KEY (ancestor, descendant)) WITHOUT ROWID;"
+                              "CREATE INDEX IF NOT EXISTS idx_property_closure_descendant ON property_closure(descendant, depth);"
+                              "CREATE TRIGGER IF NOT EXISTS property_node_insert AFTER INSERT ON property_nodes BEGIN "
+                              "INSERT INTO property_closure (ancestor, descendant, depth)"
+                              " SELECT NEW.id, NEW.id, 0"
+                              " UNION ALL SELECT ancestor, NEW.id, depth + 1 FROM property_closure"
+                              " WHERE descendant = NEW.parent_id; END;"
+                              "CREATE TRIGGER IF NOT EXISTS property_node_cycle BEFORE UPDATE OF parent_id ON property_nodes"
+                              " WHEN NEW.parent_id IS NOT NULL BEGIN "
+                              "SELECT RAISE(ABORT, 'a property node cannot be moved under itself')"
+                              " WHERE EXISTS (SELECT 1 FROM property_closure"
+                              " WHERE ancestor = NEW.id AND descendant = NEW.parent_id); END;"
+                              // Cut the subtree from its old ancestors, then join it to the new ones
+                              "CREATE TRIGGER IF NOT EXISTS property_node_move AFTER UPDATE OF parent_id ON property_nodes"
+                              " WHEN NEW.parent_id IS NOT OLD.parent_id BEGIN "
+                              "DELETE FROM property_closure"
+                              " WHERE descendant IN (SELECT descendant FROM property_closure WHERE ancestor = NEW.id)"
+                              " AND ancestor IN (SELECT ancestor FROM property_closure"
+                              " WHERE descendant = NEW.id AND ancestor <> NEW.id);"
+                              "INSERT INTO property_closure (ancestor, descendant, depth)"
+                              " SELECT a.ancestor, d.descendant, a.depth + d.depth + 1"
+                              " FROM property_closure a, property_closure d"
+                              " WHERE a.descendant = NEW.parent_id AND d.ancestor = NEW.id; END;"
+                              "CREATE TRIGGER IF NOT EXISTS property_node_delete BEFORE DELETE ON property_nodes BEGIN "
+                              "UPDATE property_nodes SET parent_id = OLD.parent_id WHERE parent_id = OLD.id;"
+                              "DELETE FROM property_closure WHERE descendant = OLD.id; END;"
+                              // Flats and rooms carry their node with them
+                              "CREATE TRIGGER IF NOT EXISTS flats_node_insert AFTER INSERT ON flats BEGIN "
+                              "INSERT INTO property_nodes (node_type, ref_id, name) VALUES ('flat', NEW.id, NEW.number); END;"
+                              "CREATE TRIGGER IF NOT EXISTS flats_node_rename AFTER UPDATE OF number ON flats BEGIN "
+                              "UPDATE property_nodes SET name = NEW.number WHERE node_type = 'flat' AND ref_id = NEW.id; END;"
+                              "CREATE TRIGGER IF NOT EXISTS flats_node_delete AFTER DELETE ON flats BEGIN "
+                              "DELETE FROM property_nodes WHERE node_type = 'flat' AND ref_id = OLD.id; END;"
+                              "CREATE TRIGGER IF NOT EXISTS rooms_node_insert AFTER INSERT ON rooms BEGIN "
+                              "INSERT INTO property_nodes (node_type, ref_id, name) VALUES ('room', NEW.id, NEW.number); END;"
+                              "CREATE TRIGGER IF NOT EXISTS rooms_node_rename AFTER UPDATE OF number ON rooms BEGIN "
+                              "UPDATE property_nodes SET name = NEW.number WHERE node_type = 'room' AND ref_id = NEW.id; END;"
+                              "CREATE TRIGGER IF NOT EXISTS rooms_node_delete AFTER DELETE ON rooms BEGIN "
+                              "DELETE FROM property_nodes WHERE node_type = 'room' AND ref_id = OLD.id; END;";
+
+    rc = sqlite3_exec(db, create_tree, 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    // Flats and rooms created before the property tree become unplaced nodes
+    if (backfill_nodes) {
+        rc = sqlite3_exec(db, "INSERT INTO property_nodes (node_type, ref_id, name)"
+                              " SELECT 'flat', id, number FROM flats;"
+                              "INSERT INTO property_nodes (node_type, ref_id, name)"
+                              " SELECT 'room', id, number FROM rooms;", 0, 0, 0);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            return;
+        }
+    }
+
+    // Change tracking for incremental exports
+    const char *create_tracking = "CREATE TABLE IF NOT EXISTS export_tombstones ("
+                                  "seq INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                  "table_name TEXT NOT NULL,"
+                                  "row_id INTEGER NOT NULL,"
+                                  "deleted_at TEXT NOT NULL);"
+                                  "CREATE TABLE IF NOT EXISTS export_watermarks ("
+                                  "table_name TEXT PRIMARY KEY,"
+                                  "updated_at TEXT,"
+                                  "last_id INTEGER NOT NULL DEFAULT 0,"
+                                  "exported_at TEXT NOT NULL);";
+
+    rc = sqlite3_exec(db, create_tracking, 0, 0, 0);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    static const char *tracked_tables[] = {"rooms", "flats", "tenants", "tenancies", "invoices", "payments"};
+    for (size_t t = 0; t < sizeof(tracked_tables) / sizeof(tracked_tables[0]); t++) {
+        const char *table = tracked_tables[t];
+        char sql[2048];
+
+        if (!columnExists(db, table, "updated_at")) {
+            snprintf(sql, sizeof(sql), "ALTER TABLE %s ADD COLUMN updated_at TEXT;"
+                     "UPDATE %s SET updated_at = strftime('%%Y-%%m-%%d %%H:%%M:%%f', 'now');",
+                     table, table);
+            rc = sqlite3_exec(db, sql, 0, 0, 0);
+            if (rc != SQLITE_OK) {
+                fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+                return;
+            }
+        }
+
+        snprintf(sql, sizeof(sql),
+                 "CREATE INDEX IF NOT EXISTS idx_%s_updated_at ON %s(updated_at);"
+                 "CREATE TRIGGER IF NOT EXISTS %s_stamp_insert AFTER INSERT ON %s"
+                 " WHEN NEW.updated_at IS NULL BEGIN "
+                 "UPDATE %s SET updated_at = strftime('%%Y-%%m-%%d %%H:%%M:%%f', 'now') WHERE id = NEW.id; END;"
+                 "CREATE TRIGGER IF NOT EXISTS %s_stamp_update AFTER UPDATE ON %s"
+                 " WHEN NEW.updated_at IS OLD.updated_at BEGIN "
+                 "UPDATE %s SET updated_at = strftime('%%Y-%%m-%%d %%H:%%M:%%f', 'now') WHERE id = NEW.id; END;"
+                 "CREATE TRIGGER IF NOT EXISTS %s_tombstone AFTER DELETE ON %s BEGIN "
+                 "INSERT INTO export_tombstones (table_name, row_id, deleted_at)"
+                 " VALUES ('%s', OLD.id, strftime('%%Y-%%m-%%d %%H:%%M:%%f', 'now')); END;",
+                 table, table, table, table, table, table, table, table, table, table, table);
+        rc = sqlite3_exec(db, sql, 0, 0, 0);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            return;
+        }
+    }
+
+    if (backfill) {
+        rc = sqlite3_exec(db, "INSERT INTO tenancy_intervals "
+                              "SELECT id, unit_id * 2 + (unit_type = 'room'), unit_id * 2 + (unit_type = 'room'),"
+                              " CAST(julianday(start_date) AS INTEGER),"
+                              " COALESCE(CAST(julianday(end_date) AS INTEGER), 9999999) FROM tenancies;", 0, 0, 0);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            return;
+        }
+    }
+}
+
+// Returns 1 if the table has a column with the given name
+int columnExists(sqlite3 *db, const char *table, const char *column) {
+    sqlite3_stmt *stmt = NULL;
+    int exists = 0;
+
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM pragma_table_info(?) WHERE name = ?;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, column, -1, SQLITE_STATIC);
+    exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+// Returns 1 if a table (or virtual table) with the given name exists
+int tableExists(sqlite3 *db, const char *name) {
+    sqlite3_stmt *stmt = NULL;
+    int exists = 0;
+
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return exists;
 }
 
 void showMainMenu(sqlite3 *db) {
@@ -126,20 +780,16 @@ void showMainMenu(sqlite3 *db) {
             propertyMenu(db);
             break;
         case 2:
-            printf("Tenant Management - Coming soon!\n");
-            waitForEnter();
+            tenantManagementMenu(db);
             break;
         case 3:
-            printf("Rent and Utility Management - Coming soon!\n");
-            waitForEnter();
+            rentUtilityMenu(db);
             break;
         case 4:
-            printf("Reports - Coming soon!\n");
-            waitForEnter();
+            reportsMenu(db);
             break;
         case 5:
-            printf("Data Export - Coming soon!\n");
-            waitForEnter();
+            dataExportMenu(db);
             break;
         default:
             printf("Invalid choice. Please try again.\n");
@@ -155,12 +805,13 @@ void propertyMenu(sqlite3 *db) {
         printf("\n=== PROPERTY STRUCTURE MANAGEMENT ===\n\n");
         printf("1. Room Management\n");
         printf("2. Flat Management\n");
+        printf("3. Buildings and Floors\n");
         printf("0. Return to Main Menu\n");
         printf("\nEnter your choice: ");
 
         if (scanf("%d", &choice) != 1) {
             clearInputBuffer();
-            printf("Invalid input. Please enter a number between 0 and 2.\n");
+            printf("Invalid input. Please enter a number between 0 and 3.\n");
             waitForEnter();
             continue;
         }
@@ -173,10 +824,13 @@ void propertyMenu(sqlite3 *db) {
             case 2:
                 flatManagementMenu(db);
                 break;
+            case 3:
+                propertyTreeMenu(db);
+                break;
             case 0:
                 return;
             default:
-                printf("Invalid choice. Please enter a number between 0 and 2.\n");
+                printf("Invalid choice. Please enter a number between 0 and 3.\n");
                 waitForEnter();
         }
     }
@@ -480,19 +1134,25 @@ void deleteRoom(sqlite3 *db) {
         return;
     }
     
-    char sql[100];
-    sprintf(sql, "DELETE FROM rooms WHERE id = %d;", room_id);
-    
-    char *err_msg = 0;
-    int rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
+    // Rooms can be let too; keep the tenancy history of one that was
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "DELETE FROM rooms WHERE id = ?1"
+                      " AND NOT EXISTS (SELECT 1 FROM tenancies WHERE unit_type = 'room' AND unit_id = ?1);";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, room_id);
     
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
         printf("\nFailed to delete room!\n");
+    } else if (sqlite3_changes(db) == 0) {
+        printf("\nRoom %d does not exist or has tenancy history and cannot be deleted.\n", room_id);
     } else {
         printf("\nRoom deleted successfully!\n");
     }
+    sqlite3_finalize(stmt);
     
     // waitForEnter();
 }
@@ -523,30 +1183,3310 @@ void flatManagementMenu(sqlite3 *db) {
 
         switch (choice) {
             case 1:
-                printf("Add New Flat - Coming soon!\n");
-                waitForEnter();
+                addNewFlat(db);
                 break;
             case 2:
-                printf("View All Flats - Coming soon!\n");
-                waitForEnter();
+                viewAllFlats(db);
                 break;
             case 3:
-                printf("Edit Flat - Coming soon!\n");
-                waitForEnter();
+                editFlat(db);
                 break;
             case 4:
-                printf("Delete Flat - Coming soon!\n");
-                waitForEnter();
+                deleteFlat(db);
                 break;
             case 5:
-                printf("Assign Rooms to Flat - Coming soon!\n");
-                waitForEnter();
+                assignRoomsToFlat(db);
                 break;
             case 0:
                 return;
             default:
                 printf("Invalid choice. Please try again.\n");
-                waitForEnter();
         }
+
+        waitForEnter();
+    }
+}
+
+// Looks up a node id by type and name under a parent (parent_id 0 for any
+// parent). Returns -1 if there is no such node.
+static int findNode(sqlite3 *db, const char *node_type, const char *name, int parent_id) {
+    sqlite3_stmt *stmt = NULL;
+    int id = -1;
+    const char *sql = "SELECT id FROM property_nodes WHERE node_type = ?1 AND name = ?2"
+                      " AND (?3 = 0 OR parent_id = ?3) ORDER BY id LIMIT 1;";
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, node_type, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, name, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, parent_id);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        id = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return id;
+}
+
+// Asks for a building and, optionally, one of its floors. Returns the node
+// id of the floor (or of the building when the floor is left blank), 0 when
+// the building is left blank and blank is allowed, and -1 on a bad answer.
+static int promptLocation(sqlite3 *db, int allow_blank) {
+    char building[100];
+    char floor[100];
+
+    promptLine(allow_blank ? "Building (blank for none): " : "Building: ", building, sizeof(building));
+    if (building[0] == '\0') {
+        if (allow_blank) {
+            return 0;
+        }
+        printf("Building name is required.\n");
+        return -1;
+    }
+    int building_id = findNode(db, "building", building, 0);
+    if (building_id < 0) {
+        printf("No building named '%s'.\n", building);
+        return -1;
+    }
+
+    promptLine("Floor (blank for the whole building): ", floor, sizeof(floor));
+    if (floor[0] == '\0') {
+        return building_id;
+    }
+    int floor_id = findNode(db, "floor", floor, building_id);
+    if (floor_id < 0) {
+        printf("No floor '%s' in building '%s'.\n", floor, building);
+    }
+    return floor_id;
+}
+
+// Moves the node of a flat or room under a new parent node (0 for none)
+static int setNodeParent(sqlite3 *db, const char *node_type, int ref_id, int parent_id) {
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "UPDATE property_nodes SET parent_id = NULLIF(?3, 0) WHERE node_type = ?1 AND ref_id = ?2;";
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, node_type, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, ref_id);
+    sqlite3_bind_int(stmt, 3, parent_id);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    return 0;
+}
+
+// Add new flat, optionally placing it in a building or on a floor
+void addNewFlat(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== ADD NEW FLAT ===\n\n");
+
+    char number[50];
+    char description[200];
+
+    promptLine("Enter flat number: ", number, sizeof(number));
+    if (number[0] == '\0') {
+        printf("Flat number is required.\n");
+        return;
+    }
+    promptLine("Enter flat description (optional): ", description, sizeof(description));
+    int parent_id = promptLocation(db, 1);
+    if (parent_id < 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_exec(db, "BEGIN;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    if (sqlite3_prepare_v2(db, "INSERT INTO flats (number, description) VALUES (?, NULLIF(?, ''));",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        goto rollback;
+    }
+    sqlite3_bind_text(stmt, 1, number, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, description, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        goto rollback;
+    }
+    int flat_id = (int)sqlite3_last_insert_rowid(db);
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+
+    if (parent_id > 0 && setNodeParent(db, "flat", flat_id, parent_id) != 0) {
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        printf("\nFailed to add flat!\n");
+        return;
+    }
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK) {
+        goto rollback;
+    }
+    printf("\nFlat added successfully!\n");
+    return;
+
+rollback:
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+    printf("\nFailed to add flat!\n");
+}
+
+void viewAllFlats(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== ALL FLATS ===\n\n");
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT f.id, f.number,"
+                      " COALESCE((SELECT group_concat(name, ' / ') FROM (SELECT a.name FROM property_closure c"
+                      "  JOIN property_nodes a ON a.id = c.ancestor"
+                      "  WHERE c.descendant = n.id AND c.depth > 0 ORDER BY c.depth DESC)), '-'),"
+                      " (SELECT COUNT(*) FROM property_nodes r WHERE r.parent_id = n.id AND r.node_type = 'room'),"
+                      " f.description"
+                      " FROM flats f JOIN property_nodes n ON n.node_type = 'flat' AND n.ref_id = f.id"
+                      " ORDER BY f.number;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    printf("%-5s %-12s %-25s %-6s %-30s\n", "ID", "Flat Number", "Location", "Rooms", "Description");
+    printf("-------------------------------------------------------------------------------\n");
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *description = (const char*)sqlite3_column_text(stmt, 4);
+        printf("%-5d %-12s %-25.25s %-6d %-30s\n", sqlite3_column_int(stmt, 0),
+               (const char*)sqlite3_column_text(stmt, 1),
+               (const char*)sqlite3_column_text(stmt, 2),
+               sqlite3_column_int(stmt, 3),
+               description ? description : "-");
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+
+    if (count == 0) {
+        printf("No flats found in database.\n");
+    } else {
+        printf("\nTotal flats: %d\n", count);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Edit existing flat information
+void editFlat(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== EDIT FLAT ===\n\n");
+
+    viewAllFlats(db);
+
+    int flat_id;
+    char line[32];
+    char new_number[50];
+    char new_description[200];
+
+    promptLine("\nEnter flat ID to edit: ", line, sizeof(line));
+    if (sscanf(line, "%d", &flat_id) != 1) {
+        printf("Invalid flat ID.\n");
+        return;
     }
+    promptLine("Enter new flat number (leave blank to keep current): ", new_number, sizeof(new_number));
+    promptLine("Enter new description (leave blank to keep current): ", new_description, sizeof(new_description));
+
+    if (new_number[0] == '\0' && new_description[0] == '\0') {
+        printf("No changes made.\n");
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "UPDATE flats SET number = COALESCE(NULLIF(?1, ''), number),"
+                      " description = COALESCE(NULLIF(?2, ''), description) WHERE id = ?3;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, new_number, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, new_description, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, flat_id);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to update flat!\n");
+    } else if (sqlite3_changes(db) == 0) {
+        printf("\nNo flat with ID %d.\n", flat_id);
+    } else {
+        printf("\nFlat information updated successfully!\n");
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Delete a flat; its rooms stay, moved up to the flat's floor
+void deleteFlat(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== DELETE FLAT ===\n\n");
+
+    viewAllFlats(db);
+
+    int flat_id;
+    char line[32];
+
+    promptLine("\nEnter flat ID to delete: ", line, sizeof(line));
+    if (sscanf(line, "%d", &flat_id) != 1) {
+        printf("Invalid flat ID.\n");
+        return;
+    }
+    promptLine("Are you sure you want to delete this flat? (y/n): ", line, sizeof(line));
+    if (tolower(line[0]) != 'y') {
+        printf("Deletion canceled.\n");
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "DELETE FROM flats WHERE id = ?1"
+                      " AND NOT EXISTS (SELECT 1 FROM tenancies WHERE unit_type = 'flat' AND unit_id = ?1);";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, flat_id);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to delete flat!\n");
+    } else if (sqlite3_changes(db) == 0) {
+        printf("\nFlat %d does not exist or has tenancy history and cannot be deleted.\n", flat_id);
+    } else {
+        printf("\nFlat deleted successfully!\n");
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Move rooms under a flat; the closure triggers re-link each room's subtree
+void assignRoomsToFlat(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== ASSIGN ROOMS TO FLAT ===\n\n");
+
+    char flat_number[50];
+    char rooms[500];
+
+    promptLine("Flat number: ", flat_number, sizeof(flat_number));
+    int flat_node = findNode(db, "flat", flat_number, 0);
+    if (flat_node < 0) {
+        printf("No flat with number '%s'.\n", flat_number);
+        return;
+    }
+    promptLine("Room numbers (comma separated): ", rooms, sizeof(rooms));
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "UPDATE property_nodes SET parent_id = ?1 WHERE node_type = 'room' AND name = ?2;";
+    if (sqlite3_exec(db, "BEGIN;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, flat_node);
+
+    int assigned = 0;
+    for (char *room = strtok(rooms, ","); room != NULL; room = strtok(NULL, ",")) {
+        while (isspace((unsigned char)*room)) room++;
+        char *end = room + strlen(room);
+        while (end > room && isspace((unsigned char)end[-1])) *--end = '\0';
+        if (*room == '\0') {
+            continue;
+        }
+
+        sqlite3_bind_text(stmt, 2, room, -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            sqlite3_finalize(stmt);
+            sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+            printf("\nNo rooms were assigned.\n");
+            return;
+        }
+        if (sqlite3_changes(db) == 0) {
+            printf("Room '%s' not found, skipped.\n", room);
+        } else {
+            assigned++;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        return;
+    }
+    printf("\n%d room(s) assigned to flat %s.\n", assigned, flat_number);
+}
+
+
+// Property Hierarchy Functions
+void propertyTreeMenu(sqlite3 *db) {
+    int choice;
+
+    while (1) {
+        clearScreen();
+        printf("\n==============================================\n");
+        printf("           BUILDINGS AND FLOORS\n");
+        printf("==============================================\n");
+        printf("1. Add Building\n");
+        printf("2. Add Floor to Building\n");
+        printf("3. Place Flat in Building or on Floor\n");
+        printf("4. View Property Tree\n");
+        printf("5. Units, Rent and Occupancy Under a Building or Floor\n");
+        printf("0. Return to Previous Menu\n");
+        printf("\nEnter your choice: ");
+
+        if (scanf("%d", &choice) != 1) {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number.\n");
+            waitForEnter();
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice) {
+            case 1:
+                addBuilding(db);
+                break;
+            case 2:
+                addFloor(db);
+                break;
+            case 3:
+                placeFlatOnFloor(db);
+                break;
+            case 4:
+                viewPropertyTree(db);
+                break;
+            case 5:
+                unitsUnderNode(db);
+                break;
+            case 0:
+                return;
+            default:
+                printf("Invalid choice. Please try again.\n");
+        }
+
+        waitForEnter();
+    }
+}
+
+static int insertNode(sqlite3 *db, const char *node_type, const char *name, int parent_id) {
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "INSERT INTO property_nodes (node_type, name, parent_id) VALUES (?, ?, NULLIF(?, 0));";
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, node_type, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, name, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, parent_id);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    return 0;
+}
+
+void addBuilding(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== ADD BUILDING ===\n\n");
+
+    char name[100];
+    promptLine("Building name: ", name, sizeof(name));
+    if (name[0] == '\0') {
+        printf("Building name is required.\n");
+        return;
+    }
+    if (findNode(db, "building", name, 0) >= 0) {
+        printf("A building named '%s' already exists.\n", name);
+        return;
+    }
+    if (insertNode(db, "building", name, 0) == 0) {
+        printf("\nBuilding added successfully!\n");
+    }
+}
+
+void addFloor(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== ADD FLOOR ===\n\n");
+
+    char building[100];
+    char name[100];
+
+    promptLine("Building: ", building, sizeof(building));
+    int building_id = findNode(db, "building", building, 0);
+    if (building_id < 0) {
+        printf("No building named '%s'.\n", building);
+        return;
+    }
+    promptLine("Floor name: ", name, sizeof(name));
+    if (name[0] == '\0') {
+        printf("Floor name is required.\n");
+        return;
+    }
+    if (findNode(db, "floor", name, building_id) >= 0) {
+        printf("Building '%s' already has a floor '%s'.\n", building, name);
+        return;
+    }
+    if (insertNode(db, "floor", name, building_id) == 0) {
+        printf("\nFloor added successfully!\n");
+    }
+}
+
+void placeFlatOnFloor(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== PLACE FLAT ===\n\n");
+
+    char number[50];
+    promptLine("Flat number: ", number, sizeof(number));
+    int flat_node = findNode(db, "flat", number, 0);
+    if (flat_node < 0) {
+        printf("No flat with number '%s'.\n", number);
+        return;
+    }
+    int parent_id = promptLocation(db, 1);
+    if (parent_id < 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(db, "UPDATE property_nodes SET parent_id = NULLIF(?, 0) WHERE id = ?;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, parent_id);
+    sqlite3_bind_int(stmt, 2, flat_node);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to place flat!\n");
+    } else {
+        printf("\nFlat %s %s.\n", number, parent_id ? "placed" : "is no longer placed in a building");
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Depth-first listing of every building; unplaced flats and rooms are only
+// counted
+void viewPropertyTree(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== PROPERTY TREE ===\n\n");
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "WITH RECURSIVE tree(id, node_type, name, level) AS ("
+                      " SELECT id, node_type, name, 0 FROM property_nodes"
+                      "  WHERE parent_id IS NULL AND node_type IN ('building', 'floor')"
+                      " UNION ALL"
+                      " SELECT n.id, n.node_type, n.name, t.level + 1"
+                      "  FROM tree t JOIN property_nodes n ON n.parent_id = t.id"
+                      " ORDER BY 4 DESC)"
+                      " SELECT node_type, name, level FROM tree;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        printf("%*s%s %s\n", sqlite3_column_int(stmt, 2) * 4, "",
+               (const char*)sqlite3_column_text(stmt, 0),
+               (const char*)sqlite3_column_text(stmt, 1));
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+
+    if (count == 0) {
+        printf("No buildings defined yet.\n");
+    }
+
+    sql = "SELECT SUM(node_type = 'flat'), SUM(node_type = 'room') FROM property_nodes"
+          " WHERE parent_id IS NULL AND node_type IN ('flat', 'room');";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        printf("\nUnplaced flats: %d, top-level rooms: %d\n",
+               sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Every flat and room under a building or floor, at any depth, with the
+// tenancy covering today. The subtree comes from one range scan of the
+// closure table and each unit is one probe of the tenancy interval index.
+void unitsUnderNode(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== UNITS UNDER A BUILDING OR FLOOR ===\n\n");
+
+    int node_id = promptLocation(db, 0);
+    if (node_id < 0) {
+        return;
+    }
+
+    char today[DATE_SIZE];
+    todayDate(today);
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT n.node_type, n.name, c.depth, p.name, tn.name, t.monthly_rent"
+                      " FROM property_closure c"
+                      " JOIN property_nodes n ON n.id = c.descendant"
+                      " LEFT JOIN property_nodes p ON p.id = n.parent_id"
+                      " LEFT JOIN tenancy_intervals i"
+                      "  ON i.unit_lo <= n.ref_id * 2 + (n.node_type = 'room')"
+                      "  AND i.unit_hi >= n.ref_id * 2 + (n.node_type = 'room')"
+                      "  AND i.start_day <= CAST(julianday(?2) AS INTEGER)"
+                      "  AND i.end_day >= CAST(julianday(?2) AS INTEGER)"
+                      " LEFT JOIN tenancies t ON t.id = i.id"
+                      " LEFT JOIN tenants tn ON tn.id = t.tenant_id"
+                      " WHERE c.ancestor = ?1 AND n.node_type IN ('flat', 'room')"
+                      " ORDER BY n.node_type, p.name, n.name;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, node_id);
+    sqlite3_bind_text(stmt, 2, today, -1, SQLITE_STATIC);
+
+    printf("\n%-5s %-12s %-15s %-22s %10s\n", "Type", "Unit", "Parent", "Tenant today", "Rent");
+    printf("-----------------------------------------------------------------------\n");
+
+    // Counters indexed by UNIT_FLAT / UNIT_ROOM
+    int units[2] = {0, 0};
+    int occupied[2] = {0, 0};
+    double rent = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *type = (const char*)sqlite3_column_text(stmt, 0);
+        const char *parent = (const char*)sqlite3_column_text(stmt, 3);
+        const char *tenant = (const char*)sqlite3_column_text(stmt, 4);
+        int kind = strcmp(type, "room") == 0 ? UNIT_ROOM : UNIT_FLAT;
+
+        printf("%-5s %-12.12s %-15.15s %-22.22s ", type,
+               (const char*)sqlite3_column_text(stmt, 1), parent ? parent : "-",
+               tenant ? tenant : "(vacant)");
+        if (tenant) {
+            printf("%10.2f\n", sqlite3_column_double(stmt, 5));
+            occupied[kind]++;
+            rent += sqlite3_column_double(stmt, 5);
+        } else {
+            printf("%10s\n", "-");
+        }
+        units[kind]++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+
+    int total = units[UNIT_FLAT] + units[UNIT_ROOM];
+    if (total == 0) {
+        printf("No flats or rooms here yet.\n");
+        return;
+    }
+    printf("-----------------------------------------------------------------------\n");
+    printf("Flats: %d (%d let)  Rooms: %d (%d let)\n",
+           units[UNIT_FLAT], occupied[UNIT_FLAT], units[UNIT_ROOM], occupied[UNIT_ROOM]);
+    printf("Occupancy today: %.1f%%  Monthly rent roll: %.2f\n",
+           100.0 * (occupied[UNIT_FLAT] + occupied[UNIT_ROOM]) / total, rent);
+}
+
+
+// Tenant Management Functions
+
+// Reads one line into buf without the trailing newline
+static void promptLine(const char *prompt, char *buf, int size) {
+    printf("%s", prompt);
+    if (fgets(buf, size, stdin) == NULL) {
+        buf[0] = '\0';
+        return;
+    }
+    if (strchr(buf, '\n') == NULL) {
+        clearInputBuffer();  // Drop the rest of an over-long line
+    }
+    buf[strcspn(buf, "\n")] = 0;
+}
+
+// Checks that a string is a real calendar date in YYYY-MM-DD form
+static int isValidDate(const char *date) {
+    static const int days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int year, month, day;
+    char extra;
+
+    if (strlen(date) != 10 || sscanf(date, "%4d-%2d-%2d%c", &year, &month, &day, &extra) != 3) {
+        return 0;
+    }
+    if (year < 1900 || month < 1 || month > 12 || day < 1) {
+        return 0;
+    }
+    int leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return day <= days_in_month[month - 1] + (month == 2 && leap);
+}
+
+static void todayDate(char *buf) {
+    time_t now = time(NULL);
+    strftime(buf, DATE_SIZE, "%Y-%m-%d", localtime(&now));
+}
+
+// Prompts for a date; a blank answer is today when allow_blank is set and
+// leaves buf empty otherwise. Returns 0 on success and -1 on a bad date.
+static int promptDate(const char *prompt, char *buf, int allow_blank) {
+    char line[32];
+
+    promptLine(prompt, line, sizeof(line));
+    if (line[0] == '\0') {
+        if (allow_blank) {
+            todayDate(buf);
+        } else {
+            buf[0] = '\0';
+        }
+        return 0;
+    }
+    if (!isValidDate(line)) {
+        printf("Invalid date. Please use YYYY-MM-DD.\n");
+        return -1;
+    }
+    strcpy(buf, line);
+    return 0;
+}
+
+// Asks for a unit type and number and resolves it to the unit's id.
+// Returns 0 and fills kind/id on success, -1 if the unit is unknown.
+static int promptUnit(sqlite3 *db, int *kind, int *id) {
+    char type[8];
+    char number[50];
+    sqlite3_stmt *stmt = NULL;
+
+    promptLine("Unit type (f = flat, r = room): ", type, sizeof(type));
+    if (tolower(type[0]) == 'f') {
+        *kind = UNIT_FLAT;
+    } else if (tolower(type[0]) == 'r') {
+        *kind = UNIT_ROOM;
+    } else {
+        printf("Invalid unit type.\n");
+        return -1;
+    }
+    promptLine(*kind == UNIT_FLAT ? "Flat number: " : "Room number: ", number, sizeof(number));
+
+    const char *sql = *kind == UNIT_FLAT ? "SELECT id FROM flats WHERE number = ?;"
+                                         : "SELECT id FROM rooms WHERE number = ?;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, number, -1, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *id = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_ROW) {
+        printf("No %s with number '%s'.\n", *kind == UNIT_FLAT ? "flat" : "room", number);
+        return -1;
+    }
+    return 0;
+}
+
+void tenantManagementMenu(sqlite3 *db) {
+    int choice;
+
+    while (1) {
+        clearScreen();
+        printf("\n==============================================\n");
+        printf("           TENANT MANAGEMENT\n");
+        printf("==============================================\n");
+        printf("1. Add New Tenant\n");
+        printf("2. View All Tenants\n");
+        printf("3. Start Tenancy\n");
+        printf("4. End Tenancy\n");
+        printf("5. View Active Tenancies\n");
+        printf("6. Who Occupied a Unit on a Date\n");
+        printf("7. Vacant Units Today\n");
+        printf("8. Occupancy Rate by Month\n");
+        printf("9. Upcoming Lease Events (next %d days)\n", LEASE_EVENT_WINDOW_DAYS);
+        printf("10. Schedule Rent Review\n");
+        printf("0. Return to Main Menu\n");
+        printf("\nEnter your choice: ");
+
+        if (scanf("%d", &choice) != 1) {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number.\n");
+            waitForEnter();
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice) {
+            case 1:
+                addTenant(db);
+                break;
+            case 2:
+                viewTenants(db);
+                break;
+            case 3:
+                startTenancy(db);
+                break;
+            case 4:
+                endTenancy(db);
+                break;
+            case 5:
+                viewActiveTenancies(db);
+                break;
+            case 6:
+                unitOccupantOnDate(db);
+                break;
+            case 7:
+                vacantUnitsToday(db);
+                break;
+            case 8:
+                monthlyOccupancyRate(db);
+                break;
+            case 9:
+                upcomingLeaseEvents(db);
+                break;
+            case 10:
+                scheduleRentReview(db);
+                break;
+            case 0:
+                return;
+            default:
+                printf("Invalid choice. Please try again.\n");
+        }
+
+        waitForEnter();
+    }
+}
+
+void addTenant(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== ADD NEW TENANT ===\n\n");
+
+    char name[100];
+    char phone[30];
+    char email[100];
+
+    promptLine("Enter tenant name: ", name, sizeof(name));
+    if (name[0] == '\0') {
+        printf("Tenant name is required.\n");
+        return;
+    }
+    promptLine("Enter phone (optional): ", phone, sizeof(phone));
+    promptLine("Enter email (optional): ", email, sizeof(email));
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "INSERT INTO tenants (name, phone, email) VALUES (?, NULLIF(?, ''), NULLIF(?, ''));";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, phone, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, email, -1, SQLITE_STATIC);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to add tenant!\n");
+    } else {
+        printf("\nTenant added successfully with ID %lld!\n", sqlite3_last_insert_rowid(db));
+    }
+    sqlite3_finalize(stmt);
+}
+
+void viewTenants(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== ALL TENANTS ===\n\n");
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT id, name, phone, email FROM tenants ORDER BY name, id;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    printf("%-5s %-25s %-15s %-30s\n", "ID", "Name", "Phone", "Email");
+    printf("------------------------------------------------------------------------------\n");
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *name = (const char*)sqlite3_column_text(stmt, 1);
+        const char *phone = (const char*)sqlite3_column_text(stmt, 2);
+        const char *email = (const char*)sqlite3_column_text(stmt, 3);
+
+        printf("%-5d %-25s %-15s %-30s\n", sqlite3_column_int(stmt, 0),
+               name ? name : "-", phone ? phone : "-", email ? email : "-");
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+
+    if (count == 0) {
+        printf("No tenants found in database.\n");
+    } else {
+        printf("\nTotal tenants: %d\n", count);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Start a tenancy after checking the interval index for an overlapping one
+// on the same unit; the check and the insert share one write transaction
+void startTenancy(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== START TENANCY ===\n\n");
+
+    int tenant_id, kind, unit_id;
+    double rent, deposit = 0;
+    char start_date[DATE_SIZE];
+    char end_date[DATE_SIZE];
+    char review_date[DATE_SIZE];
+    char line[32];
+
+    promptLine("Enter tenant ID: ", line, sizeof(line));
+    if (sscanf(line, "%d", &tenant_id) != 1) {
+        printf("Invalid tenant ID.\n");
+        return;
+    }
+    if (promptUnit(db, &kind, &unit_id) != 0) {
+        return;
+    }
+    if (promptDate("Start date (YYYY-MM-DD, blank for today): ", start_date, 1) != 0 ||
+        promptDate("End date (YYYY-MM-DD, blank if open-ended): ", end_date, 0) != 0) {
+        return;
+    }
+    if (end_date[0] != '\0' && strcmp(end_date, start_date) < 0) {
+        printf("End date cannot be before the start date.\n");
+        return;
+    }
+    promptLine("Monthly rent: ", line, sizeof(line));
+    if (sscanf(line, "%lf", &rent) != 1 || rent < 0) {
+        printf("Invalid rent amount.\n");
+        return;
+    }
+    promptLine("Deposit held (blank for none): ", line, sizeof(line));
+    if (line[0] != '\0' && (sscanf(line, "%lf", &deposit) != 1 || deposit < 0)) {
+        printf("Invalid deposit amount.\n");
+        return;
+    }
+    if (promptDate("Next rent review (YYYY-MM-DD, blank for none): ", review_date, 0) != 0) {
+        return;
+    }
+    if (review_date[0] != '\0' && strcmp(review_date, start_date) <= 0) {
+        printf("Rent review must be after the start date.\n");
+        return;
+    }
+
+    sqlite3_stmt *check = NULL;
+    sqlite3_stmt *insert = NULL;
+    int unit_key = unit_id * 2 + kind;
+
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    const char *check_sql = "SELECT n.name, t.start_date, COALESCE(t.end_date, 'open')"
+                            " FROM tenancy_intervals i"
+                            " JOIN tenancies t ON t.id = i.id"
+                            " JOIN tenants n ON n.id = t.tenant_id"
+                            " WHERE i.unit_lo <= ?1 AND i.unit_hi >= ?1"
+                            " AND i.start_day <= COALESCE(CAST(julianday(NULLIF(?3, '')) AS INTEGER), 9999999)"
+                            " AND i.end_day >= CAST(julianday(?2) AS INTEGER)"
+                            " LIMIT 1;";
+    if (sqlite3_prepare_v2(db, check_sql, -1, &check, NULL) != SQLITE_OK) {
+        goto rollback;
+    }
+    sqlite3_bind_int(check, 1, unit_key);
+    sqlite3_bind_text(check, 2, start_date, -1, SQLITE_STATIC);
+    sqlite3_bind_text(check, 3, end_date, -1, SQLITE_STATIC);
+
+    int rc = sqlite3_step(check);
+    if (rc == SQLITE_ROW) {
+        printf("\nUnit is already let to %s from %s to %s.\n",
+               (const char*)sqlite3_column_text(check, 0),
+               (const char*)sqlite3_column_text(check, 1),
+               (const char*)sqlite3_column_text(check, 2));
+        sqlite3_finalize(check);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        return;
+    }
+    if (rc != SQLITE_DONE) {
+        goto rollback;
+    }
+
+    const char *insert_sql = "INSERT INTO tenancies (tenant_id, unit_type, unit_id, start_date, end_date, monthly_rent,"
+                             " deposit, rent_review_date)"
+                             " SELECT id, ?2, ?3, ?4, NULLIF(?5, ''), ?6, ?7, NULLIF(?8, '') FROM tenants WHERE id = ?1;";
+    if (sqlite3_prepare_v2(db, insert_sql, -1, &insert, NULL) != SQLITE_OK) {
+        goto rollback;
+    }
+    sqlite3_bind_int(insert, 1, tenant_id);
+    sqlite3_bind_text(insert, 2, kind == UNIT_FLAT ? "flat" : "room", -1, SQLITE_STATIC);
+    sqlite3_bind_int(insert, 3, unit_id);
+    sqlite3_bind_text(insert, 4, start_date, -1, SQLITE_STATIC);
+    sqlite3_bind_text(insert, 5, end_date, -1, SQLITE_STATIC);
+    sqlite3_bind_double(insert, 6, rent);
+    sqlite3_bind_double(insert, 7, deposit);
+    sqlite3_bind_text(insert, 8, review_date, -1, SQLITE_STATIC);
+
+    if (sqlite3_step(insert) != SQLITE_DONE) {
+        goto rollback;
+    }
+    if (sqlite3_changes(db) == 0) {
+        printf("\nNo tenant with ID %d.\n", tenant_id);
+        sqlite3_finalize(check);
+        sqlite3_finalize(insert);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        return;
+    }
+    long long tenancy_id = sqlite3_last_insert_rowid(db);
+
+    sqlite3_finalize(check);
+    sqlite3_finalize(insert);
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        return;
+    }
+    printf("\nTenancy %lld started successfully!\n", tenancy_id);
+    return;
+
+rollback:
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    sqlite3_finalize(check);
+    sqlite3_finalize(insert);
+    sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+    printf("\nFailed to start tenancy!\n");
+}
+
+// Close an open tenancy; the update trigger shortens its interval
+void endTenancy(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== END TENANCY ===\n\n");
+
+    viewActiveTenancies(db);
+
+    int tenancy_id;
+    char end_date[DATE_SIZE];
+    char line[32];
+
+    promptLine("\nEnter tenancy ID to end: ", line, sizeof(line));
+    if (sscanf(line, "%d", &tenancy_id) != 1) {
+        printf("Invalid tenancy ID.\n");
+        return;
+    }
+    if (promptDate("Last day of tenancy (YYYY-MM-DD, blank for today): ", end_date, 1) != 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "UPDATE tenancies SET end_date = ?1"
+                      " WHERE id = ?2 AND (end_date IS NULL OR end_date > ?1) AND start_date <= ?1;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, end_date, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, tenancy_id);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to end tenancy!\n");
+    } else if (sqlite3_changes(db) == 0) {
+        printf("\nTenancy %d is not running on %s.\n", tenancy_id, end_date);
+    } else {
+        printf("\nTenancy %d ends on %s.\n", tenancy_id, end_date);
+    }
+    sqlite3_finalize(stmt);
+}
+
+static const char *leaseEventLabel(const char *event_type) {
+    if (strcmp(event_type, "lease_end") == 0) {
+        return "Lease ends";
+    }
+    if (strcmp(event_type, "rent_review") == 0) {
+        return "Rent review";
+    }
+    return "Return deposit";
+}
+
+// Lease events due between today and LEASE_EVENT_WINDOW_DAYS from now
+void upcomingLeaseEvents(sqlite3 *db) {
+    char today[DATE_SIZE];
+    todayDate(today);
+
+    clearScreen();
+    printf("\n=== LEASE EVENTS, NEXT %d DAYS (from %s) ===\n\n", LEASE_EVENT_WINDOW_DAYS, today);
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT e.due_date, CAST(julianday(e.due_date) - julianday(?1) AS INTEGER), e.event_type,"
+                      " t.id, n.name, t.unit_type, COALESCE(f.number, r.number, '?'), t.monthly_rent, t.deposit"
+                      " FROM lease_events e"
+                      " JOIN tenancies t ON t.id = e.tenancy_id"
+                      " JOIN tenants n ON n.id = t.tenant_id"
+                      " LEFT JOIN flats f ON t.unit_type = 'flat' AND f.id = t.unit_id"
+                      " LEFT JOIN rooms r ON t.unit_type = 'room' AND r.id = t.unit_id"
+                      " WHERE e.due_date >= ?1 AND e.due_date <= date(?1, '+' || ?2 || ' days')"
+                      " ORDER BY e.due_date, e.id;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, today, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, LEASE_EVENT_WINDOW_DAYS);
+
+    printf("%-11s %5s %-15s %-7s %-22s %-5s %-10s %10s\n",
+           "Due", "Days", "Event", "Tenancy", "Tenant", "Type", "Unit", "Amount");
+    printf("-------------------------------------------------------------------------------------------\n");
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *event_type = (const char*)sqlite3_column_text(stmt, 2);
+        // Rent for a review, the deposit for a return, nothing for an end
+        int column = strcmp(event_type, "rent_review") == 0 ? 7 :
+                     strcmp(event_type, "deposit_return") == 0 ? 8 : -1;
+        char amount[16] = "";
+        if (column >= 0) {
+            snprintf(amount, sizeof(amount), "%.2f", sqlite3_column_double(stmt, column));
+        }
+        printf("%-11s %5d %-15s %-7d %-22.22s %-5s %-10.10s %10s\n",
+               (const char*)sqlite3_column_text(stmt, 0),
+               sqlite3_column_int(stmt, 1),
+               leaseEventLabel(event_type),
+               sqlite3_column_int(stmt, 3),
+               (const char*)sqlite3_column_text(stmt, 4),
+               (const char*)sqlite3_column_text(stmt, 5),
+               (const char*)sqlite3_column_text(stmt, 6),
+               amount);
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    }
+    if (count == 0) {
+        printf("No lease events in the next %d days.\n", LEASE_EVENT_WINDOW_DAYS);
+    } else {
+        printf("\n%d event(s).\n", count);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Set or clear the next rent review date of a tenancy
+void scheduleRentReview(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== SCHEDULE RENT REVIEW ===\n\n");
+
+    viewActiveTenancies(db);
+
+    int tenancy_id;
+    char review_date[DATE_SIZE];
+    char line[32];
+
+    promptLine("\nEnter tenancy ID: ", line, sizeof(line));
+    if (sscanf(line, "%d", &tenancy_id) != 1) {
+        printf("Invalid tenancy ID.\n");
+        return;
+    }
+    if (promptDate("Next rent review (YYYY-MM-DD, blank to clear): ", review_date, 0) != 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "UPDATE tenancies SET rent_review_date = NULLIF(?1, '')"
+                      " WHERE id = ?2 AND (?1 = '' OR ?1 > start_date);";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, review_date, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, tenancy_id);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to schedule rent review!\n");
+    } else if (sqlite3_changes(db) == 0) {
+        printf("\nNo tenancy %d starting before %s.\n", tenancy_id, review_date);
+    } else if (review_date[0] == '\0') {
+        printf("\nRent review for tenancy %d cleared.\n", tenancy_id);
+    } else {
+        printf("\nRent review for tenancy %d scheduled for %s.\n", tenancy_id, review_date);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Startup banner: counts of lease events coming up in the window, if any
+void showLeaseAlerts(sqlite3 *db) {
+    char today[DATE_SIZE];
+    todayDate(today);
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT event_type, COUNT(*), MIN(due_date) FROM lease_events"
+                      " WHERE due_date >= ?1 AND due_date <= date(?1, '+' || ?2 || ' days')"
+                      " GROUP BY event_type ORDER BY MIN(due_date);";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, today, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, LEASE_EVENT_WINDOW_DAYS);
+
+    int shown = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (!shown) {
+            printf("**********************************************\n");
+            printf("  LEASE ALERTS - next %d days\n", LEASE_EVENT_WINDOW_DAYS);
+            shown = 1;
+        }
+        printf("  %-15s %5d  (first on %s)\n",
+               leaseEventLabel((const char*)sqlite3_column_text(stmt, 0)),
+               sqlite3_column_int(stmt, 1),
+               (const char*)sqlite3_column_text(stmt, 2));
+    }
+    if (shown) {
+        printf("  See Tenant Management > Upcoming Lease Events\n");
+        printf("**********************************************\n\n");
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Tenancies covering today, found through the interval index
+void viewActiveTenancies(sqlite3 *db) {
+    char today[DATE_SIZE];
+    todayDate(today);
+
+    printf("\n=== ACTIVE TENANCIES (%s) ===\n\n", today);
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT t.id, n.name, t.unit_type, COALESCE(f.number, r.number, '?'),"
+                      " t.start_date, COALESCE(t.end_date, '-'), t.monthly_rent"
+                      " FROM tenancy_intervals i"
+                      " JOIN tenancies t ON t.id = i.id"
+                      " JOIN tenants n ON n.id = t.tenant_id"
+                      " LEFT JOIN flats f ON t.unit_type = 'flat' AND f.id = t.unit_id"
+                      " LEFT JOIN rooms r ON t.unit_type = 'room' AND r.id = t.unit_id"
+                      " WHERE i.start_day <= CAST(julianday(?1) AS INTEGER)"
+                      " AND i.end_day >= CAST(julianday(?1) AS INTEGER)"
+                      " ORDER BY t.unit_type, 4;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, today, -1, SQLITE_STATIC);
+
+    printf("%-5s %-22s %-5s %-10s %-11s %-11s %10s\n",
+           "ID", "Tenant", "Type", "Unit", "Start", "End", "Rent");
+    printf("-------------------------------------------------------------------------------\n");
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        printf("%-5d %-22.22s %-5s %-10.10s %-11s %-11s %10.2f\n",
+               sqlite3_column_int(stmt, 0),
+               (const char*)sqlite3_column_text(stmt, 1),
+               (const char*)sqlite3_column_text(stmt, 2),
+               (const char*)sqlite3_column_text(stmt, 3),
+               (const char*)sqlite3_column_text(stmt, 4),
+               (const char*)sqlite3_column_text(stmt, 5),
+               sqlite3_column_double(stmt, 6));
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+
+    if (count == 0) {
+        printf("No active tenancies.\n");
+    } else {
+        printf("\nActive tenancies: %d\n", count);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Point-in-time lookup: a single R*Tree probe on (unit, day)
+void unitOccupantOnDate(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== UNIT OCCUPANT ON DATE ===\n\n");
+
+    int kind, unit_id;
+    char date[DATE_SIZE];
+
+    if (promptUnit(db, &kind, &unit_id) != 0) {
+        return;
+    }
+    if (promptDate("Date (YYYY-MM-DD, blank for today): ", date, 1) != 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT t.id, n.name, n.phone, t.start_date, COALESCE(t.end_date, 'open')"
+                      " FROM tenancy_intervals i"
+                      " JOIN tenancies t ON t.id = i.id"
+                      " JOIN tenants n ON n.id = t.tenant_id"
+                      " WHERE i.unit_lo <= ?1 AND i.unit_hi >= ?1"
+                      " AND i.start_day <= CAST(julianday(?2) AS INTEGER)"
+                      " AND i.end_day >= CAST(julianday(?2) AS INTEGER);";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, unit_id * 2 + kind);
+    sqlite3_bind_text(stmt, 2, date, -1, SQLITE_STATIC);
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        const char *phone = (const char*)sqlite3_column_text(stmt, 2);
+        printf("\nOn %s the unit was let to %s (phone: %s)\n", date,
+               (const char*)sqlite3_column_text(stmt, 1), phone ? phone : "-");
+        printf("Tenancy %d: %s to %s\n", sqlite3_column_int(stmt, 0),
+               (const char*)sqlite3_column_text(stmt, 3),
+               (const char*)sqlite3_column_text(stmt, 4));
+    } else if (rc == SQLITE_DONE) {
+        printf("\nThe unit was vacant on %s.\n", date);
+    } else {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Units with no tenancy interval covering today; each unit is one index probe
+void vacantUnitsToday(sqlite3 *db) {
+    clearScreen();
+
+    char today[DATE_SIZE];
+    todayDate(today);
+    printf("\n=== VACANT UNITS (%s) ===\n\n", today);
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT 'Flat', f.number, f.description FROM flats f"
+                      " WHERE NOT EXISTS (SELECT 1 FROM tenancy_intervals i"
+                      "  WHERE i.unit_lo <= f.id * 2 AND i.unit_hi >= f.id * 2"
+                      "  AND i.start_day <= CAST(julianday(?1) AS INTEGER)"
+                      "  AND i.end_day >= CAST(julianday(?1) AS INTEGER))"
+                      " UNION ALL "
+                      "SELECT 'Room', r.number, r.description FROM rooms r"
+                      " WHERE NOT EXISTS (SELECT 1 FROM tenancy_intervals i"
+                      "  WHERE i.unit_lo <= r.id * 2 + 1 AND i.unit_hi >= r.id * 2 + 1"
+                      "  AND i.start_day <= CAST(julianday(?1) AS INTEGER)"
+                      "  AND i.end_day >= CAST(julianday(?1) AS INTEGER))"
+                      " ORDER BY 1, 2;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, today, -1, SQLITE_STATIC);
+
+    printf("%-6s %-15s %-30s\n", "Type", "Number", "Description");
+    printf("------------------------------------------------------\n");
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *description = (const char*)sqlite3_column_text(stmt, 2);
+        printf("%-6s %-15s %-30s\n",
+               (const char*)sqlite3_column_text(stmt, 0),
+               (const char*)sqlite3_column_text(stmt, 1),
+               description ? description : "-");
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+
+    if (count == 0) {
+        printf("Every unit is let.\n");
+    } else {
+        printf("\nVacant units: %d\n", count);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Occupied unit-days over available unit-days for each month of a year.
+// Each month is one window query on the interval index, clipping every
+// overlapping tenancy to the month.
+void monthlyOccupancyRate(sqlite3 *db) {
+    static const char *month_names[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    clearScreen();
+    printf("\n=== OCCUPANCY RATE BY MONTH ===\n\n");
+
+    char line[32];
+    int year;
+    promptLine("Enter year (YYYY): ", line, sizeof(line));
+    if (sscanf(line, "%d", &year) != 1 || year < 1900 || year > 9999) {
+        printf("Invalid year.\n");
+        return;
+    }
+
+    sqlite3_stmt *units = NULL;
+    sqlite3_stmt *stmt = NULL;
+    long long unit_count = 0;
+
+    if (sqlite3_prepare_v2(db, "SELECT (SELECT COUNT(*) FROM flats) + (SELECT COUNT(*) FROM rooms);",
+                           -1, &units, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    if (sqlite3_step(units) == SQLITE_ROW) {
+        unit_count = sqlite3_column_int64(units, 0);
+    }
+    sqlite3_finalize(units);
+
+    if (unit_count == 0) {
+        printf("No flats or rooms are registered.\n");
+        return;
+    }
+
+    const char *sql = "SELECT COALESCE(SUM(MIN(i.end_day, m.hi) - MAX(i.start_day, m.lo) + 1), 0), m.hi - m.lo + 1"
+                      " FROM (SELECT CAST(julianday(?1) AS INTEGER) AS lo,"
+                      "  CAST(julianday(?1, '+1 month', '-1 day') AS INTEGER) AS hi) m"
+                      " LEFT JOIN tenancy_intervals i ON i.start_day <= m.hi AND i.end_day >= m.lo;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    printf("\nUnits: %lld\n\n", unit_count);
+    printf("%-6s %14s %14s %10s\n", "Month", "Occupied days", "Unit days", "Rate");
+    printf("-----------------------------------------------\n");
+
+    long long year_occupied = 0, year_capacity = 0;
+    for (int month = 1; month <= 12; month++) {
+        char month_start[DATE_SIZE];
+        snprintf(month_start, sizeof(month_start), "%04d-%02d-01", year, month);
+
+        sqlite3_reset(stmt);
+        sqlite3_bind_text(stmt, 1, month_start, -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_ROW) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            break;
+        }
+        long long occupied = sqlite3_column_int64(stmt, 0);
+        long long capacity = sqlite3_column_int64(stmt, 1) * unit_count;
+
+        printf("%-6s %14lld %14lld %9.1f%%\n", month_names[month - 1],
+               occupied, capacity, 100.0 * occupied / capacity);
+        year_occupied += occupied;
+        year_capacity += capacity;
+    }
+    sqlite3_finalize(stmt);
+
+    printf("-----------------------------------------------\n");
+    printf("%-6d %14lld %14lld %9.1f%%\n", year, year_occupied, year_capacity,
+           year_capacity ? 100.0 * year_occupied / year_capacity : 0.0);
+}
+
+
+// Rent and Utility Management Functions
+void rentUtilityMenu(sqlite3 *db) {
+    int choice;
+
+    while (1) {
+        clearScreen();
+        printf("\n==============================================\n");
+        printf("        RENT AND UTILITY MANAGEMENT\n");
+        printf("==============================================\n");
+        printf("1. Run Monthly Billing\n");
+        printf("2. View Invoices for a Period\n");
+        printf("3. Record Payment\n");
+        printf("4. Add Utility Meter\n");
+        printf("5. Record Meter Reading\n");
+        printf("6. View Meter Readings\n");
+        printf("7. Unit Utility Consumption\n");
+        printf("8. Late Fee Rules\n");
+        printf("9. Reconcile Bank Transactions\n");
+        printf("10. Generate Payment Receipts\n");
+        printf("0. Return to Main Menu\n");
+        printf("\nEnter your choice: ");
+
+        if (scanf("%d", &choice) != 1) {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number.\n");
+            waitForEnter();
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice) {
+            case 1:
+                runMonthlyBilling(db);
+                break;
+            case 2:
+                viewInvoicesForPeriod(db);
+                break;
+            case 3:
+                recordPayment(db);
+                break;
+            case 4:
+                addMeter(db);
+                break;
+            case 5:
+                recordMeterReading(db);
+                break;
+            case 6:
+                viewMeterReadings(db);
+                break;
+            case 7:
+                unitUtilityConsumption(db);
+                break;
+            case 8:
+                editLateFeeRules(db);
+                break;
+            case 9:
+                reconcileBankTransactions(db);
+                break;
+            case 10:
+                generateReceipts(db);
+                break;
+            case 0:
+                return;
+            default:
+                printf("Invalid choice. Please try again.\n");
+        }
+
+        waitForEnter();
+    }
+}
+
+// Prompts for a billing period; a blank answer is the current month.
+// Returns 0 on success and -1 on a bad period.
+static int promptPeriod(const char *prompt, char *period) {
+    char line[32];
+    char first_day[DATE_SIZE];
+
+    promptLine(prompt, line, sizeof(line));
+    if (line[0] == '\0') {
+        todayDate(first_day);
+        snprintf(period, PERIOD_SIZE, "%.7s", first_day);
+        return 0;
+    }
+    snprintf(first_day, sizeof(first_day), "%.7s-01", line);
+    if (strlen(line) != 7 || !isValidDate(first_day)) {
+        printf("Invalid period. Please use YYYY-MM.\n");
+        return -1;
+    }
+    strcpy(period, line);
+    return 0;
+}
+
+static double elapsedSeconds(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Generate the rent invoices for one period in a single write transaction.
+// Tenancies overlapping the month come from one window query on the
+// interval index and are inserted through one prepared statement that is
+// reset and rebound for each row; INSERT OR IGNORE skips invoices that a
+// previous run for the same period already created.
+void runMonthlyBilling(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== MONTHLY BILLING RUN ===\n\n");
+
+    char period[PERIOD_SIZE];
+    char first_day[DATE_SIZE];
+    char due_modifier[32];
+
+    if (promptPeriod("Billing period (YYYY-MM, blank for current month): ", period) != 0) {
+        return;
+    }
+    snprintf(first_day, sizeof(first_day), "%s-01", period);
+    snprintf(due_modifier, sizeof(due_modifier), "+%d days", INVOICE_DUE_DAYS);
+
+    sqlite3_stmt *select = NULL;
+    sqlite3_stmt *insert = NULL;
+    int generated = 0, skipped = 0;
+    double total = 0;
+    struct timespec started;
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    const char *select_sql = "SELECT t.id, ROUND(t.monthly_rent * (MIN(i.end_day, m.hi) - MAX(i.start_day, m.lo) + 1)"
+                             " / (m.hi - m.lo + 1), 2)"
+                             " FROM (SELECT CAST(julianday(?1) AS INTEGER) AS lo,"
+                             "  CAST(julianday(?1, '+1 month', '-1 day') AS INTEGER) AS hi) m"
+                             " JOIN tenancy_intervals i ON i.start_day <= m.hi AND i.end_day >= m.lo"
+                             " JOIN tenancies t ON t.id = i.id"
+                             " ORDER BY t.id;";
+    // Stamping updated_at here saves the insert trigger a second write per invoice
+    const char *insert_sql = "INSERT OR IGNORE INTO invoices (tenancy_id, period, issue_date, due_date, amount, updated_at)"
+                             " VALUES (?1, ?2, ?3, date(?3, ?4), ?5, strftime('%Y-%m-%d %H:%M:%f', 'now'));";
+    if (sqlite3_prepare_v2(db, select_sql, -1, &select, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, insert_sql, -1, &insert, NULL) != SQLITE_OK) {
+        goto rollback;
+    }
+    sqlite3_bind_text(select, 1, first_day, -1, SQLITE_STATIC);
+    sqlite3_bind_text(insert, 2, period, -1, SQLITE_STATIC);
+    sqlite3_bind_text(insert, 3, first_day, -1, SQLITE_STATIC);
+    sqlite3_bind_text(insert, 4, due_modifier, -1, SQLITE_STATIC);
+
+    int rc;
+    while ((rc = sqlite3_step(select)) == SQLITE_ROW) {
+        double amount = sqlite3_column_double(select, 1);
+
+        sqlite3_bind_int64(insert, 1, sqlite3_column_int64(select, 0));
+        sqlite3_bind_double(insert, 5, amount);
+        if (sqlite3_step(insert) != SQLITE_DONE) {
+            goto rollback;
+        }
+        if (sqlite3_changes(db) > 0) {
+            generated++;
+            total += amount;
+        } else {
+            skipped++;
+        }
+        sqlite3_reset(insert);
+    }
+    if (rc != SQLITE_DONE) {
+        goto rollback;
+    }
+
+    sqlite3_finalize(select);
+    sqlite3_finalize(insert);
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        return;
+    }
+
+    double seconds = elapsedSeconds(&started);
+    printf("\nBilling run for %s complete.\n", period);
+    printf("Invoices generated:     %d (total %.2f)\n", generated, total);
+    printf("Already billed:         %d\n", skipped);
+    printf("Elapsed:                %.3f s", seconds);
+    if (generated > 0 && seconds > 0) {
+        printf(" (%.0f invoices/s)", generated / seconds);
+    }
+    printf("\n");
+    return;
+
+rollback:
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    sqlite3_finalize(select);
+    sqlite3_finalize(insert);
+    sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+    printf("\nBilling run failed; no invoices were generated.\n");
+}
+
+void viewInvoicesForPeriod(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== INVOICES FOR PERIOD ===\n\n");
+
+    char period[PERIOD_SIZE];
+    if (promptPeriod("Period (YYYY-MM, blank for current month): ", period) != 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT v.id, n.name, t.unit_type, COALESCE(f.number, r.number, '?'), v.due_date, v.amount,"
+                      " COALESCE((SELECT SUM(p.amount) FROM payments p WHERE p.invoice_id = v.id), 0),"
+                      " printf('RK%07d', v.id)"
+                      " FROM invoices v"
+                      " JOIN tenancies t ON t.id = v.tenancy_id"
+                      " JOIN tenants n ON n.id = t.tenant_id"
+                      " LEFT JOIN flats f ON t.unit_type = 'flat' AND f.id = t.unit_id"
+                      " LEFT JOIN rooms r ON t.unit_type = 'room' AND r.id = t.unit_id"
+                      " WHERE v.period = ?"
+                      " ORDER BY v.id;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, period, -1, SQLITE_STATIC);
+
+    printf("%-6s %-10s %-22s %-5s %-10s %-11s %10s %10s %10s\n",
+           "ID", "Reference", "Tenant", "Type", "Unit", "Due", "Amount", "Paid", "Balance");
+    printf("------------------------------------------------------------------------------------------------------\n");
+
+    int count = 0;
+    double billed = 0, paid = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        double amount = sqlite3_column_double(stmt, 5);
+        double received = sqlite3_column_double(stmt, 6);
+
+        printf("%-6d %-10s %-22.22s %-5s %-10.10s %-11s %10.2f %10.2f %10.2f\n",
+               sqlite3_column_int(stmt, 0),
+               (const char*)sqlite3_column_text(stmt, 7),
+               (const char*)sqlite3_column_text(stmt, 1),
+               (const char*)sqlite3_column_text(stmt, 2),
+               (const char*)sqlite3_column_text(stmt, 3),
+               (const char*)sqlite3_column_text(stmt, 4),
+               amount, received, amount - received);
+        billed += amount;
+        paid += received;
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+
+    if (count == 0) {
+        printf("No invoices for %s. Run the billing for this period first.\n", period);
+    } else {
+        printf("\nInvoices: %d  Billed: %.2f  Paid: %.2f  Outstanding: %.2f\n",
+               count, billed, paid, billed - paid);
+    }
+    sqlite3_finalize(stmt);
+}
+
+void recordPayment(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== RECORD PAYMENT ===\n\n");
+
+    int invoice_id;
+    double amount;
+    char paid_on[DATE_SIZE];
+    char method[30];
+    char line[32];
+
+    promptLine("Enter invoice ID: ", line, sizeof(line));
+    if (sscanf(line, "%d", &invoice_id) != 1) {
+        printf("Invalid invoice ID.\n");
+        return;
+    }
+    promptLine("Amount paid: ", line, sizeof(line));
+    if (sscanf(line, "%lf", &amount) != 1 || amount <= 0) {
+        printf("Invalid amount.\n");
+        return;
+    }
+    if (promptDate("Payment date (YYYY-MM-DD, blank for today): ", paid_on, 1) != 0) {
+        return;
+    }
+    promptLine("Payment method (optional): ", method, sizeof(method));
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "INSERT INTO payments (invoice_id, amount, paid_on, method)"
+                      " SELECT id, ?2, ?3, NULLIF(?4, '') FROM invoices WHERE id = ?1;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, invoice_id);
+    sqlite3_bind_double(stmt, 2, amount);
+    sqlite3_bind_text(stmt, 3, paid_on, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, method, -1, SQLITE_STATIC);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to record payment!\n");
+    } else if (sqlite3_changes(db) == 0) {
+        printf("\nNo invoice with ID %d.\n", invoice_id);
+    } else {
+        printf("\nPayment of %.2f recorded against invoice %d.\n", amount, invoice_id);
+    }
+    sqlite3_finalize(stmt);
+}
+
+void addMeter(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== ADD UTILITY METER ===\n\n");
+
+    char serial[50];
+    char utility[8];
+    int kind, unit_id;
+
+    promptLine("Meter serial number: ", serial, sizeof(serial));
+    if (serial[0] == '\0') {
+        printf("Serial number is required.\n");
+        return;
+    }
+    promptLine("Utility (e = electricity, w = water): ", utility, sizeof(utility));
+    if (tolower(utility[0]) != 'e' && tolower(utility[0]) != 'w') {
+        printf("Invalid utility.\n");
+        return;
+    }
+    if (promptUnit(db, &kind, &unit_id) != 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "INSERT INTO meters (serial, utility, unit_type, unit_id) VALUES (?, ?, ?, ?);";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, serial, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, tolower(utility[0]) == 'e' ? "electricity" : "water", -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, kind == UNIT_FLAT ? "flat" : "room", -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, unit_id);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to add meter!\n");
+    } else {
+        printf("\nMeter %s added successfully!\n", serial);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Looks up a meter by serial number. Returns its id, or -1 if unknown.
+static int findMeter(sqlite3 *db, const char *serial) {
+    sqlite3_stmt *stmt = NULL;
+    int id = -1;
+
+    if (sqlite3_prepare_v2(db, "SELECT id FROM meters WHERE serial = ?;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, serial, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        id = sqlite3_column_int(stmt, 0);
+    } else {
+        printf("No meter with serial '%s'.\n", serial);
+    }
+    sqlite3_finalize(stmt);
+    return id;
+}
+
+// Store a reading; re-entering a date replaces its value. The triggers work
+// out the consumption and update the rollups in the same statement.
+void recordMeterReading(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== RECORD METER READING ===\n\n");
+
+    char serial[50];
+    char reading_date[DATE_SIZE];
+    char line[32];
+    double value;
+
+    promptLine("Meter serial number: ", serial, sizeof(serial));
+    int meter_id = findMeter(db, serial);
+    if (meter_id < 0) {
+        return;
+    }
+    if (promptDate("Reading date (YYYY-MM-DD, blank for today): ", reading_date, 1) != 0) {
+        return;
+    }
+    promptLine("Meter value: ", line, sizeof(line));
+    if (sscanf(line, "%lf", &value) != 1 || value < 0) {
+        printf("Invalid meter value.\n");
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "INSERT INTO meter_readings (meter_id, reading_date, value) VALUES (?1, ?2, ?3)"
+                      " ON CONFLICT (meter_id, reading_date) DO UPDATE SET value = excluded.value;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, meter_id);
+    sqlite3_bind_text(stmt, 2, reading_date, -1, SQLITE_STATIC);
+    sqlite3_bind_double(stmt, 3, value);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        printf("\nFailed to record reading!\n");
+        return;
+    }
+
+    sql = "SELECT consumption FROM meter_readings WHERE meter_id = ? AND reading_date = ?;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, meter_id);
+    sqlite3_bind_text(stmt, 2, reading_date, -1, SQLITE_STATIC);
+
+    printf("\nReading recorded.\n");
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (sqlite3_column_type(stmt, 0) == SQLITE_NULL) {
+            printf("This is the first reading for meter %s.\n", serial);
+        } else {
+            double consumption = sqlite3_column_double(stmt, 0);
+            printf("Consumption since previous reading: %.2f\n", consumption);
+            if (consumption < 0) {
+                printf("Warning: value is lower than the previous reading.\n");
+            }
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+void viewMeterReadings(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== METER READINGS ===\n\n");
+
+    char serial[50];
+    promptLine("Meter serial number: ", serial, sizeof(serial));
+    int meter_id = findMeter(db, serial);
+    if (meter_id < 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT reading_date, value, consumption FROM meter_readings"
+                      " WHERE meter_id = ? ORDER BY reading_date;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, meter_id);
+
+    printf("\n%-12s %12s %12s\n", "Date", "Value", "Consumption");
+    printf("--------------------------------------\n");
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        printf("%-12s %12.2f ", (const char*)sqlite3_column_text(stmt, 0), sqlite3_column_double(stmt, 1));
+        if (sqlite3_column_type(stmt, 2) == SQLITE_NULL) {
+            printf("%12s\n", "-");
+        } else {
+            printf("%12.2f\n", sqlite3_column_double(stmt, 2));
+        }
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+
+    if (count == 0) {
+        printf("No readings recorded for this meter.\n");
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Monthly consumption of one unit, read straight from the rollups
+void unitUtilityConsumption(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== UNIT UTILITY CONSUMPTION ===\n\n");
+
+    int kind, unit_id;
+    if (promptUnit(db, &kind, &unit_id) != 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT period,"
+                      " SUM(CASE WHEN utility = 'electricity' THEN consumption END),"
+                      " SUM(CASE WHEN utility = 'water' THEN consumption END)"
+                      " FROM utility_rollups WHERE unit_type = ? AND unit_id = ?"
+                      " GROUP BY period ORDER BY period;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, kind == UNIT_FLAT ? "flat" : "room", -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, unit_id);
+
+    printf("\n%-8s %14s %14s\n", "Period", "Electricity", "Water");
+    printf("------------------------------------\n");
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        printf("%-8s %14.2f %14.2f\n", (const char*)sqlite3_column_text(stmt, 0),
+               sqlite3_column_double(stmt, 1), sqlite3_column_double(stmt, 2));
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+
+    if (count == 0) {
+        printf("No consumption recorded for this unit.\n");
+    }
+    sqlite3_finalize(stmt);
+}
+
+
+// Reports Functions
+void reportsMenu(sqlite3 *db) {
+    int choice;
+
+    while (1) {
+        clearScreen();
+        printf("\n==============================================\n");
+        printf("                 REPORTS\n");
+        printf("==============================================\n");
+        printf("1. Utility Consumption by Period\n");
+        printf("2. Occupancy Rate by Month\n");
+        printf("3. Arrears and Aging\n");
+        printf("0. Return to Main Menu\n");
+        printf("\nEnter your choice: ");
+
+        if (scanf("%d", &choice) != 1) {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number.\n");
+            waitForEnter();
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice) {
+            case 1:
+                utilityConsumptionReport(db);
+                break;
+            case 2:
+                monthlyOccupancyRate(db);
+                break;
+            case 3:
+                arrearsReport(db);
+                break;
+            case 0:
+                return;
+            default:
+                printf("Invalid choice. Please try again.\n");
+        }
+
+        waitForEnter();
+    }
+}
+
+// Show the late fee rules and let each one be changed; blank keeps it
+void editLateFeeRules(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== LATE FEE RULES ===\n\n");
+
+    sqlite3_stmt *stmt = NULL;
+    int grace_days = 0;
+    double flat_fee = 0, monthly_rate = 0, max_fee = 0;
+
+    if (sqlite3_prepare_v2(db, "SELECT grace_days, flat_fee, monthly_rate, max_fee FROM late_fee_rules WHERE id = 1;",
+                           -1, &stmt, NULL) != SQLITE_OK || sqlite3_step(stmt) != SQLITE_ROW) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        return;
+    }
+    grace_days = sqlite3_column_int(stmt, 0);
+    flat_fee = sqlite3_column_double(stmt, 1);
+    monthly_rate = sqlite3_column_double(stmt, 2);
+    max_fee = sqlite3_column_double(stmt, 3);
+    sqlite3_finalize(stmt);
+
+    printf("Grace period:     %d days after the due date\n", grace_days);
+    printf("Flat fee:         %.2f\n", flat_fee);
+    printf("Monthly rate:     %.2f%% of the unpaid amount per started 30 days\n", monthly_rate);
+    printf("Maximum fee:      %.2f per invoice (0 = no cap)\n\n", max_fee);
+
+    char line[32];
+    promptLine("New grace period in days (blank to keep): ", line, sizeof(line));
+    if (line[0] != '\0' && (sscanf(line, "%d", &grace_days) != 1 || grace_days < 0)) {
+        printf("Invalid grace period.\n");
+        return;
+    }
+    promptLine("New flat fee (blank to keep): ", line, sizeof(line));
+    if (line[0] != '\0' && (sscanf(line, "%lf", &flat_fee) != 1 || flat_fee < 0)) {
+        printf("Invalid flat fee.\n");
+        return;
+    }
+    promptLine("New monthly rate in percent (blank to keep): ", line, sizeof(line));
+    if (line[0] != '\0' && (sscanf(line, "%lf", &monthly_rate) != 1 || monthly_rate < 0)) {
+        printf("Invalid monthly rate.\n");
+        return;
+    }
+    promptLine("New maximum fee, 0 for none (blank to keep): ", line, sizeof(line));
+    if (line[0] != '\0' && (sscanf(line, "%lf", &max_fee) != 1 || max_fee < 0)) {
+        printf("Invalid maximum fee.\n");
+        return;
+    }
+
+    if (sqlite3_prepare_v2(db, "UPDATE late_fee_rules SET grace_days = ?, flat_fee = ?, monthly_rate = ?, max_fee = ?"
+                               " WHERE id = 1;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, grace_days);
+    sqlite3_bind_double(stmt, 2, flat_fee);
+    sqlite3_bind_double(stmt, 3, monthly_rate);
+    sqlite3_bind_double(stmt, 4, max_fee);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    } else {
+        printf("\nLate fee rules saved.\n");
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Parses an RK reference into the invoice id it names, or returns 0
+static int parsePaymentReference(const char *ref) {
+    int id = 0;
+
+    if (toupper((unsigned char)ref[0]) != 'R' || toupper((unsigned char)ref[1]) != 'K' || strlen(ref) != 9) {
+        return 0;
+    }
+    for (int i = 2; i < 9; i++) {
+        if (!isdigit((unsigned char)ref[i])) {
+            return 0;
+        }
+        id = id * 10 + (ref[i] - '0');
+    }
+    return id;
+}
+
+static BankTransaction *findTransaction(BankTransaction *table, size_t mask, int invoice_id) {
+    size_t slot = ((unsigned)invoice_id * 2654435761u) & mask;
+
+    while (table[slot].invoice_id != 0) {
+        if (table[slot].invoice_id == invoice_id) {
+            return &table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return &table[slot];
+}
+
+// Match one month of bank transactions to outstanding invoices and report
+// what is left unmatched on either side
+void reconcileBankTransactions(sqlite3 *db) {
+    static const char *status_names[] = {"no outstanding invoice", "matched", "paid before invoice issued",
+                                         "amount differs from balance", "already recorded"};
+    clearScreen();
+    printf("\n=== RECONCILE BANK TRANSACTIONS ===\n\n");
+
+    char bank_path[EXPORT_PATH_SIZE];
+    char period[PERIOD_SIZE];
+    char first_day[DATE_SIZE];
+
+    promptLine("Bank records database (blank for email_records.db): ", bank_path, sizeof(bank_path));
+    if (bank_path[0] == '\0') {
+        strcpy(bank_path, "email_records.db");
+    }
+    FILE *probe = fopen(bank_path, "rb");
+    if (probe == NULL) {
+        perror(bank_path);
+        return;
+    }
+    fclose(probe);
+    if (promptPeriod("Month to reconcile (YYYY-MM, blank for current month): ", period) != 0) {
+        return;
+    }
+    snprintf(first_day, sizeof(first_day), "%s-01", period);
+
+    sqlite3_stmt *stmt = NULL;
+    BankTransaction *table = NULL;
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    if (sqlite3_prepare_v2(db, "ATTACH DATABASE ? AS bank;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, bank_path, -1, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    if (sqlite3_prepare_v2(db, "SELECT"
+                               " EXISTS (SELECT 1 FROM bank.sqlite_master WHERE type = 'table' AND name = 'transactions'),"
+                               " EXISTS (SELECT 1 FROM pragma_table_info('transactions', 'bank') WHERE name = 'amount');",
+                           -1, &stmt, NULL) != SQLITE_OK || sqlite3_step(stmt) != SQLITE_ROW) {
+        goto cleanup;
+    }
+    if (!sqlite3_column_int(stmt, 0)) {
+        printf("%s has no transactions table.\n", bank_path);
+        sqlite3_finalize(stmt);
+        sqlite3_exec(db, "DETACH DATABASE bank;", 0, 0, 0);
+        return;
+    }
+    int has_amount = sqlite3_column_int(stmt, 1);
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+
+    // Build side: the month's transactions, found through idx_date. The
+    // table is sized to at least twice the row count, rounded to a power of 2.
+    long long count = 0;
+    if (sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM bank.transactions"
+                               " WHERE date >= ?1 AND date < date(?1, '+1 month');",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        goto cleanup;
+    }
+    sqlite3_bind_text(stmt, 1, first_day, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+
+    size_t slots = 16;
+    while (slots < (size_t)count * 2) slots <<= 1;
+    size_t mask = slots - 1;
+    table = calloc(slots, sizeof(BankTransaction));
+    if (table == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        goto cleanup;
+    }
+
+    const char *load_sql = has_amount
+        ? "SELECT ref_number, bank_name, date, CAST(julianday(date) AS INTEGER), amount,"
+          " EXISTS (SELECT 1 FROM main.payments WHERE reference = ref_number) FROM bank.transactions"
+          " WHERE date >= ?1 AND date < date(?1, '+1 month') ORDER BY date, ref_number;"
+        : "SELECT ref_number, bank_name, date, CAST(julianday(date) AS INTEGER), NULL,"
+          " EXISTS (SELECT 1 FROM main.payments WHERE reference = ref_number) FROM bank.transactions"
+          " WHERE date >= ?1 AND date < date(?1, '+1 month') ORDER BY date, ref_number;";
+    if (sqlite3_prepare_v2(db, load_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        goto cleanup;
+    }
+    sqlite3_bind_text(stmt, 1, first_day, -1, SQLITE_STATIC);
+
+    int unparsed = 0, posted_before = 0;
+    long long loaded = 0;
+    printf("\nTransactions without a valid invoice reference:\n");
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *ref = (const char*)sqlite3_column_text(stmt, 0);
+        int invoice_id = parsePaymentReference(ref ? ref : "");
+        loaded++;
+
+        BankTransaction *txn = invoice_id ? findTransaction(table, mask, invoice_id) : NULL;
+        if (txn == NULL || txn->invoice_id != 0) {
+            // Unparseable, or a second reference naming the same invoice
+            if (unparsed++ < RECONCILE_LIST_LIMIT) {
+                printf("  %-12s %-11s %s\n", ref ? ref : "-",
+                       (const char*)sqlite3_column_text(stmt, 2), (const char*)sqlite3_column_text(stmt, 1));
+            }
+            continue;
+        }
+        txn->invoice_id = invoice_id;
+        snprintf(txn->ref, sizeof(txn->ref), "%s", ref);
+        snprintf(txn->bank, sizeof(txn->bank), "%s", (const char*)sqlite3_column_text(stmt, 1));
+        snprintf(txn->date, sizeof(txn->date), "%s", (const char*)sqlite3_column_text(stmt, 2));
+        txn->day = sqlite3_column_int(stmt, 3);
+        txn->has_amount = sqlite3_column_type(stmt, 4) != SQLITE_NULL;
+        txn->amount = sqlite3_column_double(stmt, 4);
+        txn->status = sqlite3_column_int(stmt, 5) ? RECONCILE_POSTED : RECONCILE_UNMATCHED;
+        posted_before += txn->status == RECONCILE_POSTED;
+    }
+    if (rc != SQLITE_DONE) {
+        goto cleanup;
+    }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+    if (unparsed == 0) {
+        printf("  (none)\n");
+    } else if (unparsed > RECONCILE_LIST_LIMIT) {
+        printf("  ... and %d more\n", unparsed - RECONCILE_LIST_LIMIT);
+    }
+
+    // Probe side: every invoice with a balance left, streamed once, so a
+    // payment made long before its invoice was issued is still caught.
+    // Invoices whose reference was already posted drop out via their balance.
+    const char *probe_sql = "SELECT v.id, v.period, v.due_date, CAST(julianday(v.issue_date) AS INTEGER),"
+                            " v.amount - COALESCE(p.paid, 0)"
+                            " FROM invoices v"
+                            " LEFT JOIN (SELECT invoice_id, SUM(amount) AS paid FROM payments GROUP BY invoice_id) p"
+                            "  ON p.invoice_id = v.id"
+                            " WHERE v.amount - COALESCE(p.paid, 0) > 0.005;";
+    if (sqlite3_prepare_v2(db, probe_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        goto cleanup;
+    }
+
+    int matched = 0, exceptions = 0, open_in_period = 0, open_older = 0;
+    long long probed = 0;
+    double matched_total = 0, open_total = 0;
+
+    printf("\nInvoices for %s with no matching transaction:\n", period);
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int invoice_id = sqlite3_column_int(stmt, 0);
+        double balance = sqlite3_column_double(stmt, 4);
+        probed++;
+
+        BankTransaction *txn = findTransaction(table, mask, invoice_id);
+        if (txn->invoice_id == invoice_id && txn->status != RECONCILE_POSTED) {
+            txn->balance = balance;
+            if (txn->day < sqlite3_column_int(stmt, 3) - RECONCILE_EARLY_DAYS) {
+                txn->status = RECONCILE_TOO_EARLY;
+            } else if (txn->has_amount && (txn->amount < balance - RECONCILE_TOLERANCE ||
+                                           txn->amount > balance + RECONCILE_TOLERANCE)) {
+                txn->status = RECONCILE_AMOUNT_DIFFERS;
+            } else {
+                txn->status = RECONCILE_MATCHED;
+                matched++;
+                matched_total += txn->has_amount ? txn->amount : balance;
+                continue;
+            }
+            exceptions++;
+        }
+
+        // Invoices for later months are not due yet and play no part
+        int order = strcmp((const char*)sqlite3_column_text(stmt, 1), period);
+        if (order > 0) {
+            continue;
+        }
+        open_total += balance;
+        if (order == 0) {
+            if (open_in_period++ < RECONCILE_LIST_LIMIT) {
+                printf("  RK%07d    due %-11s balance %10.2f\n", invoice_id,
+                       (const char*)sqlite3_column_text(stmt, 2), balance);
+            }
+        } else {
+            open_older++;
+        }
+    }
+    if (rc != SQLITE_DONE) {
+        goto cleanup;
+    }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+    if (open_in_period == 0) {
+        printf("  (none)\n");
+    } else if (open_in_period > RECONCILE_LIST_LIMIT) {
+        printf("  ... and %d more\n", open_in_period - RECONCILE_LIST_LIMIT);
+    }
+
+    // Whatever in the table is not matched is unexplained on the bank side
+    int unmatched_bank = 0;
+    printf("\nTransactions not matched to an outstanding invoice:\n");
+    for (size_t i = 0; i < slots; i++) {
+        BankTransaction *txn = &table[i];
+        if (txn->invoice_id == 0 || txn->status == RECONCILE_MATCHED || txn->status == RECONCILE_POSTED) {
+            continue;
+        }
+        if (unmatched_bank++ < RECONCILE_LIST_LIMIT) {
+            printf("  %-12s %-11s %-20.20s %s\n", txn->ref, txn->date, txn->bank, status_names[txn->status]);
+        }
+    }
+    if (unmatched_bank == 0) {
+        printf("  (none)\n");
+    } else if (unmatched_bank > RECONCILE_LIST_LIMIT) {
+        printf("  ... and %d more\n", unmatched_bank - RECONCILE_LIST_LIMIT);
+    }
+
+    double seconds = elapsedSeconds(&started);
+    printf("\n------------------------------------------------------\n");
+    printf("Bank transactions in %s:      %lld%s\n", period, loaded,
+           has_amount ? "" : " (no amount column; matched on reference and date)");
+    printf("Already recorded as payments:     %d\n", posted_before);
+    printf("Matched:                          %d (%.2f)\n", matched, matched_total);
+    printf("Unmatched transactions:           %d (%d with a reference exception)\n",
+           unmatched_bank + unparsed, exceptions);
+    printf("Open invoices for %s:        %d\n", period, open_in_period);
+    printf("Older invoices still open:        %d\n", open_older);
+    printf("Outstanding after matching:       %.2f\n", open_total);
+    printf("Reconciled in %.3f s (%lld transactions, %lld invoices)\n", seconds, loaded, probed);
+
+    if (matched > 0) {
+        char line[8];
+        promptLine("\nRecord the matched transactions as payments? (y/n): ", line, sizeof(line));
+        if (tolower(line[0]) == 'y') {
+            if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0) != SQLITE_OK ||
+                sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO payments (invoice_id, amount, paid_on, method, reference)"
+                                       " VALUES (?, ?, ?, ?, ?);", -1, &stmt, NULL) != SQLITE_OK) {
+                sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+                goto cleanup;
+            }
+            int posted = 0;
+            for (size_t i = 0; i < slots; i++) {
+                BankTransaction *txn = &table[i];
+                if (txn->invoice_id == 0 || txn->status != RECONCILE_MATCHED) {
+                    continue;
+                }
+                sqlite3_bind_int(stmt, 1, txn->invoice_id);
+                sqlite3_bind_double(stmt, 2, txn->has_amount ? txn->amount : txn->balance);
+                sqlite3_bind_text(stmt, 3, txn->date, -1, SQLITE_STATIC);
+                sqlite3_bind_text(stmt, 4, txn->bank, -1, SQLITE_STATIC);
+                sqlite3_bind_text(stmt, 5, txn->ref, -1, SQLITE_STATIC);
+                if (sqlite3_step(stmt) != SQLITE_DONE) {
+                    sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+                    goto cleanup;
+                }
+                posted += sqlite3_changes(db);
+                sqlite3_reset(stmt);
+            }
+            sqlite3_finalize(stmt);
+            stmt = NULL;
+            if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK) {
+                sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+                goto cleanup;
+            }
+            printf("%d payment(s) recorded.\n", posted);
+        }
+    }
+
+    free(table);
+    sqlite3_exec(db, "DETACH DATABASE bank;", 0, 0, 0);
+    return;
+
+cleanup:
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    sqlite3_finalize(stmt);
+    free(table);
+    sqlite3_exec(db, "DETACH DATABASE bank;", 0, 0, 0);
+}
+
+static const char *text_receipt_template =
+    "PAYMENT RECEIPT {{receipt_no}}\n"
+    "==============================================\n"
+    "Received from:   {{tenant}}\n"
+    "Unit:            {{unit}}\n"
+    "Rent period:     {{period}}\n"
+    "Invoice:         {{invoice_ref}} ({{invoice_amount}})\n"
+    "Amount received: {{amount}}\n"
+    "Date:            {{paid_on}}\n"
+    "Method:          {{method}}\n"
+    "Bank reference:  {{reference}}\n"
+    "==============================================\n"
+    "Thank you for your payment.\n";
+
+static const char *html_receipt_template =
+    "<!DOCTYPE html>\n"
+    "<html><head><meta charset=\"utf-8\"><title>Receipt {{receipt_no}}</title></head>\n"
+    "<body>\n"
+    "<h1>Payment Receipt {{receipt_no}}</h1>\n"
+    "<table>\n"
+    "<tr><th>Received from</th><td>{{tenant}}</td></tr>\n"
+    "<tr><th>Unit</th><td>{{unit}}</td></tr>\n"
+    "<tr><th>Rent period</th><td>{{period}}</td></tr>\n"
+    "<tr><th>Invoice</th><td>{{invoice_ref}} ({{invoice_amount}})</td></tr>\n"
+    "<tr><th>Amount received</th><td>{{amount}}</td></tr>\n"
+    "<tr><th>Date</th><td>{{paid_on}}</td></tr>\n"
+    "<tr><th>Method</th><td>{{method}}</td></tr>\n"
+    "<tr><th>Bank reference</th><td>{{reference}}</td></tr>\n"
+    "</table>\n"
+    "<p>Thank you for your payment.</p>\n"
+    "</body></html>\n";
+
+// Appends text to out, escaping it for HTML when asked. Returns the new
+// length, or -1 if the buffer is too small.
+static int appendReceiptText(char *out, int used, int size, const char *text, int html) {
+    for (; *text; text++) {
+        const char *piece = NULL;
+        if (html) {
+            switch (*text) {
+                case '&': piece = "&amp;"; break;
+                case '<': piece = "&lt;"; break;
+                case '>': piece = "&gt;"; break;
+                case '"': piece = "&quot;"; break;
+            }
+        }
+        int len = piece ? (int)strlen(piece) : 1;
+        if (used + len >= size) {
+            return -1;
+        }
+        if (piece) {
+            memcpy(out + used, piece, len);
+        } else {
+            out[used] = *text;
+        }
+        used += len;
+    }
+    out[used] = '\0';
+    return used;
+}
+
+// Renders one receipt. Unknown placeholders are copied through unchanged.
+// Returns the length written, or -1 if the receipt does not fit.
+static int renderReceipt(const char *template_text, const Receipt *r, int html, char *out, int size) {
+    int used = 0;
+    const char *p = template_text;
+
+    while (*p) {
+        const char *open = strstr(p, "{{");
+        const char *close = open ? strstr(open + 2, "}}") : NULL;
+        if (close == NULL) {
+            return appendReceiptText(out, used, size, p, 0);
+        }
+
+        int literal = (int)(open - p);
+        if (used + literal >= size) {
+            return -1;
+        }
+        memcpy(out + used, p, literal);
+        used += literal;
+
+        char name[32];
+        char value[128];
+        int known = 1;
+        int name_len = (int)(close - open - 2);
+        snprintf(name, sizeof(name), "%.*s", name_len < 31 ? name_len : 31, open + 2);
+
+        if (strcmp(name, "receipt_no") == 0) {
+            snprintf(value, sizeof(value), "R%07d", r->payment_id);
+        } else if (strcmp(name, "tenant") == 0) {
+            snprintf(value, sizeof(value), "%s", r->tenant);
+        } else if (strcmp(name, "unit") == 0) {
+            snprintf(value, sizeof(value), "%s", r->unit);
+        } else if (strcmp(name, "period") == 0) {
+            snprintf(value, sizeof(value), "%s", r->period);
+        } else if (strcmp(name, "invoice_ref") == 0) {
+            snprintf(value, sizeof(value), "RK%07d", r->invoice_id);
+        } else if (strcmp(name, "invoice_amount") == 0) {
+            snprintf(value, sizeof(value), "%.2f", r->invoice_amount);
+        } else if (strcmp(name, "amount") == 0) {
+            snprintf(value, sizeof(value), "%.2f", r->amount);
+        } else if (strcmp(name, "paid_on") == 0) {
+            snprintf(value, sizeof(value), "%s", r->paid_on);
+        } else if (strcmp(name, "method") == 0) {
+            snprintf(value, sizeof(value), "%s", r->method[0] ? r->method : "-");
+        } else if (strcmp(name, "reference") == 0) {
+            snprintf(value, sizeof(value), "%s", r->reference[0] ? r->reference : "-");
+        } else {
+            snprintf(value, sizeof(value), "{{%s}}", name);
+            known = 0;
+        }
+
+        used = appendReceiptText(out, used, size, value, known ? html : 0);
+        if (used < 0) {
+            return -1;
+        }
+        p = close + 2;
+    }
+    out[used] = '\0';
+    return used;
+}
+
+static void *receiptWorker(void *arg) {
+    ReceiptWorker *worker = arg;
+    ReceiptBatch *batch = worker->batch;
+    char *buffer = malloc(RECEIPT_BUFFER_SIZE);
+    char path[EXPORT_PATH_SIZE];
+    char tmp_path[EXPORT_PATH_SIZE + 8];
+
+    if (buffer == NULL) {
+        return NULL;
+    }
+    while (1) {
+        pthread_mutex_lock(&batch->lock);
+        int index = batch->next++;
+        pthread_mutex_unlock(&batch->lock);
+        if (index >= batch->count) {
+            break;
+        }
+
+        const Receipt *r = &batch->receipts[index];
+        snprintf(path, sizeof(path), "%s/receipt_R%07d.%s", batch->directory, r->payment_id, batch->extension);
+        if (access(path, F_OK) == 0) {
+            worker->skipped++;
+            continue;
+        }
+
+        int len = renderReceipt(batch->template_text, r, batch->html, buffer, RECEIPT_BUFFER_SIZE);
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+        FILE *fp = len < 0 ? NULL : fopen(tmp_path, "wb");
+        if (fp == NULL) {
+            worker->failed++;
+            continue;
+        }
+        int ok = fwrite(buffer, 1, (size_t)len, fp) == (size_t)len;
+        ok = fclose(fp) == 0 && ok;
+        if (!ok || rename(tmp_path, path) != 0) {
+            remove(tmp_path);
+            worker->failed++;
+            continue;
+        }
+        worker->written++;
+    }
+    free(buffer);
+    return NULL;
+}
+
+// Write a receipt file for every payment made in a month
+void generateReceipts(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== GENERATE PAYMENT RECEIPTS ===\n\n");
+
+    char period[PERIOD_SIZE];
+    char first_day[DATE_SIZE];
+    char format[8];
+    char template_path[EXPORT_PATH_SIZE];
+    char directory[EXPORT_PATH_SIZE - 32];
+
+    if (promptPeriod("Payment month (YYYY-MM, blank for current month): ", period) != 0) {
+        return;
+    }
+    snprintf(first_day, sizeof(first_day), "%s-01", period);
+    promptLine("Format (t = text, h = HTML): ", format, sizeof(format));
+    int html = tolower(format[0]) == 'h';
+    if (!html && tolower(format[0]) != 't') {
+        printf("Invalid format.\n");
+        return;
+    }
+    promptLine("Template file (blank for the built-in one): ", template_path, sizeof(template_path));
+    promptLine("Output directory (blank for current directory): ", directory, sizeof(directory));
+    if (directory[0] == '\0') {
+        strcpy(directory, ".");
+    }
+
+    static char template_text[RECEIPT_TEMPLATE_SIZE];
+    if (template_path[0] != '\0') {
+        FILE *fp = fopen(template_path, "rb");
+        if (fp == NULL) {
+            perror(template_path);
+            return;
+        }
+        size_t len = fread(template_text, 1, sizeof(template_text) - 1, fp);
+        int truncated = !feof(fp);
+        fclose(fp);
+        if (truncated) {
+            printf("Template is larger than %d bytes.\n", RECEIPT_TEMPLATE_SIZE - 1);
+            return;
+        }
+        template_text[len] = '\0';
+    } else {
+        snprintf(template_text, sizeof(template_text), "%s", html ? html_receipt_template : text_receipt_template);
+    }
+
+    // Read the month's payments once, through idx_payments_paid_on
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT p.id, p.invoice_id, n.name, t.unit_type || ' ' || COALESCE(f.number, r.number, '?'),"
+                      " v.period, p.paid_on, COALESCE(p.method, ''), COALESCE(p.reference, ''), p.amount, v.amount"
+                      " FROM payments p"
+                      " JOIN invoices v ON v.id = p.invoice_id"
+                      " JOIN tenancies t ON t.id = v.tenancy_id"
+                      " JOIN tenants n ON n.id = t.tenant_id"
+                      " LEFT JOIN flats f ON t.unit_type = 'flat' AND f.id = t.unit_id"
+                      " LEFT JOIN rooms r ON t.unit_type = 'room' AND r.id = t.unit_id"
+                      " WHERE p.paid_on >= ?1 AND p.paid_on < date(?1, '+1 month')"
+                      " ORDER BY p.id;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, first_day, -1, SQLITE_STATIC);
+
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    int capacity = 1024, count = 0;
+    Receipt *receipts = malloc(capacity * sizeof(Receipt));
+    int rc = SQLITE_DONE;
+    while (receipts != NULL && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (count == capacity) {
+            Receipt *grown = realloc(receipts, 2 * capacity * sizeof(Receipt));
+            if (grown == NULL) {
+                free(receipts);
+                receipts = NULL;
+                break;
+            }
+            receipts = grown;
+            capacity *= 2;
+        }
+        Receipt *r = &receipts[count++];
+        r->payment_id = sqlite3_column_int(stmt, 0);
+        r->invoice_id = sqlite3_column_int(stmt, 1);
+        snprintf(r->tenant, sizeof(r->tenant), "%s", (const char*)sqlite3_column_text(stmt, 2));
+        snprintf(r->unit, sizeof(r->unit), "%s", (const char*)sqlite3_column_text(stmt, 3));
+        snprintf(r->period, sizeof(r->period), "%s", (const char*)sqlite3_column_text(stmt, 4));
+        snprintf(r->paid_on, sizeof(r->paid_on), "%s", (const char*)sqlite3_column_text(stmt, 5));
+        snprintf(r->method, sizeof(r->method), "%s", (const char*)sqlite3_column_text(stmt, 6));
+        snprintf(r->reference, sizeof(r->reference), "%s", (const char*)sqlite3_column_text(stmt, 7));
+        r->amount = sqlite3_column_double(stmt, 8);
+        r->invoice_amount = sqlite3_column_double(stmt, 9);
+    }
+    if (receipts != NULL && rc != SQLITE_DONE) {
+        // A partial month must not be reported as a complete batch
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        free(receipts);
+        return;
+    }
+    sqlite3_finalize(stmt);
+    if (receipts == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return;
+    }
+    if (count == 0) {
+        printf("\nNo payments recorded in %s.\n", period);
+        free(receipts);
+        return;
+    }
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = cores < 1 ? 1 : cores > RECEIPT_MAX_THREADS ? RECEIPT_MAX_THREADS : (int)cores;
+    if (threads > count) {
+        threads = count;
+    }
+
+    ReceiptBatch batch = {receipts, count, 0, PTHREAD_MUTEX_INITIALIZER, template_text, html,
+                          directory, html ? "html" : "txt"};
+    pthread_t ids[RECEIPT_MAX_THREADS];
+    ReceiptWorker workers[RECEIPT_MAX_THREADS];
+    int started_threads = 0;
+
+    for (int i = 0; i < threads; i++) {
+        workers[i] = (ReceiptWorker){&batch, 0, 0, 0};
+        if (pthread_create(&ids[i], NULL, receiptWorker, &workers[i]) != 0) {
+            break;
+        }
+        started_threads++;
+    }
+    if (started_threads == 0) {
+        // No threads available: do the work on this one
+        workers[0] = (ReceiptWorker){&batch, 0, 0, 0};
+        receiptWorker(&workers[0]);
+        started_threads = 1;
+    } else {
+        for (int i = 0; i < started_threads; i++) {
+            pthread_join(ids[i], NULL);
+        }
+    }
+    pthread_mutex_destroy(&batch.lock);
+
+    int written = 0, skipped = 0, failed = 0;
+    for (int i = 0; i < started_threads; i++) {
+        written += workers[i].written;
+        skipped += workers[i].skipped;
+        failed += workers[i].failed;
+    }
+    double seconds = elapsedSeconds(&started);
+    free(receipts);
+
+    printf("\nPayments in %s:     %d\n", period, count);
+    printf("Receipts written:      %d\n", written);
+    printf("Already existed:       %d\n", skipped);
+    if (failed > 0) {
+        printf("Failed:                %d\n", failed);
+    }
+    printf("Worker threads:        %d\n", started_threads);
+    printf("Elapsed:               %.3f s", seconds);
+    if (written > 0 && seconds > 0) {
+        printf(" (%.0f receipts/s)", written / seconds);
+    }
+    printf("\nReceipts are in %s\n", directory);
+}
+
+// Keeps the largest debts seen so far, sorted by amount owed
+static void rememberDebtor(ArrearsRow *top, int *count, const ArrearsRow *row) {
+    double owed = row->outstanding + row->fees;
+    int pos = *count < ARREARS_TOP ? (*count)++ : ARREARS_TOP;
+
+    if (pos == ARREARS_TOP) {
+        if (owed <= top[ARREARS_TOP - 1].outstanding + top[ARREARS_TOP - 1].fees) {
+            return;
+        }
+        pos = ARREARS_TOP - 1;
+    }
+    while (pos > 0 && top[pos - 1].outstanding + top[pos - 1].fees < owed) {
+        top[pos] = top[pos - 1];
+        pos--;
+    }
+    top[pos] = *row;
+}
+
+// Arrears as of a date: outstanding rent per tenancy after crediting
+// payments oldest invoice first, the late fees due on it, and an aging
+// summary by days past due. Invoices and payment totals are streamed in
+// tenancy order and merged in one pass.
+void arrearsReport(sqlite3 *db) {
+    static const char *bucket_names[ARREARS_BUCKETS] = {"Not yet due", "0-30 days", "31-60 days",
+                                                        "61-90 days", "Over 90 days"};
+    clearScreen();
+    printf("\n=== ARREARS AND AGING ===\n\n");
+
+    char as_of[DATE_SIZE];
+    if (promptDate("As of date (YYYY-MM-DD, blank for today): ", as_of, 1) != 0) {
+        return;
+    }
+
+    sqlite3_stmt *rules = NULL;
+    sqlite3_stmt *invoices = NULL;
+    sqlite3_stmt *payments = NULL;
+    int grace_days = 0;
+    double flat_fee = 0, monthly_rate = 0, max_fee = 0;
+    struct timespec started;
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    sqlite3_exec(db, "BEGIN;", 0, 0, 0);
+
+    if (sqlite3_prepare_v2(db, "SELECT grace_days, flat_fee, monthly_rate, max_fee,"
+                               " CAST(julianday(?) AS INTEGER) FROM late_fee_rules WHERE id = 1;",
+                           -1, &rules, NULL) != SQLITE_OK) {
+        goto cleanup;
+    }
+    sqlite3_bind_text(rules, 1, as_of, -1, SQLITE_STATIC);
+    if (sqlite3_step(rules) != SQLITE_ROW) {
+        goto cleanup;
+    }
+    grace_days = sqlite3_column_int(rules, 0);
+    flat_fee = sqlite3_column_double(rules, 1);
+    monthly_rate = sqlite3_column_double(rules, 2);
+    max_fee = sqlite3_column_double(rules, 3);
+    int as_of_day = sqlite3_column_int(rules, 4);
+
+    // Both cursors come back in tenancy order: invoices through the
+    // (tenancy_id, period) unique index, payment totals through a GROUP BY
+    const char *invoice_sql = "SELECT tenancy_id, CAST(julianday(due_date) AS INTEGER), amount FROM invoices"
+                              " WHERE issue_date <= ?1 ORDER BY tenancy_id, period;";
+    const char *payment_sql = "SELECT v.tenancy_id, SUM(p.amount) FROM payments p"
+                              " JOIN invoices v ON v.id = p.invoice_id"
+                              " WHERE p.paid_on <= ?1 GROUP BY v.tenancy_id ORDER BY v.tenancy_id;";
+    if (sqlite3_prepare_v2(db, invoice_sql, -1, &invoices, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, payment_sql, -1, &payments, NULL) != SQLITE_OK) {
+        goto cleanup;
+    }
+    sqlite3_bind_text(invoices, 1, as_of, -1, SQLITE_STATIC);
+    sqlite3_bind_text(payments, 1, as_of, -1, SQLITE_STATIC);
+
+    double aging[ARREARS_BUCKETS] = {0};
+    double total_fees = 0, total_credit = 0;
+    long long invoice_count = 0;
+    int debtors = 0, listed = 0;
+    ArrearsRow top[ARREARS_TOP];
+    ArrearsRow current = {-1, 0, 0, 0};
+    double credit = 0;
+
+    int payment_rc = sqlite3_step(payments);
+    int rc;
+    while (1) {
+        rc = sqlite3_step(invoices);
+        int tenancy_id = rc == SQLITE_ROW ? sqlite3_column_int(invoices, 0) : -1;
+
+        if (tenancy_id != current.tenancy_id) {
+            // Close the previous tenancy
+            if (current.tenancy_id >= 0) {
+                if (current.outstanding > 0.005) {
+                    debtors++;
+                    rememberDebtor(top, &listed, &current);
+                }
+                total_credit += credit;
+            }
+            if (rc != SQLITE_ROW) {
+                break;
+            }
+
+            // Advance the payment cursor to this tenancy; payments for
+            // tenancies without invoices in range are skipped
+            while (payment_rc == SQLITE_ROW && sqlite3_column_int(payments, 0) < tenancy_id) {
+                payment_rc = sqlite3_step(payments);
+            }
+            credit = 0;
+            if (payment_rc == SQLITE_ROW && sqlite3_column_int(payments, 0) == tenancy_id) {
+                credit = sqlite3_column_double(payments, 1);
+            }
+            current.tenancy_id = tenancy_id;
+            current.outstanding = 0;
+            current.fees = 0;
+            current.oldest_days = 0;
+        }
+
+        int due_day = sqlite3_column_int(invoices, 1);
+        double unpaid = sqlite3_column_double(invoices, 2);
+        invoice_count++;
+
+        double applied = credit < unpaid ? credit : unpaid;
+        credit -= applied;
+        unpaid -= applied;
+        if (unpaid < 0.005) {
+            continue;
+        }
+
+        int days_overdue = as_of_day - due_day;
+        int bucket = days_overdue < 0 ? 0 : days_overdue <= 30 ? 1 : days_overdue <= 60 ? 2
+                   : days_overdue <= 90 ? 3 : 4;
+        aging[bucket] += unpaid;
+
+        if (days_overdue > grace_days) {
+            double fee = flat_fee + unpaid * monthly_rate / 100.0 * ((days_overdue + 29) / 30);
+            if (max_fee > 0 && fee > max_fee) {
+                fee = max_fee;
+            }
+            current.fees += fee;
+            total_fees += fee;
+        }
+        if (current.outstanding == 0 && days_overdue > 0) {
+            current.oldest_days = days_overdue;
+        }
+        current.outstanding += unpaid;
+    }
+    if (rc != SQLITE_DONE || (payment_rc != SQLITE_ROW && payment_rc != SQLITE_DONE)) {
+        goto cleanup;
+    }
+    double seconds = elapsedSeconds(&started);
+
+    // Name the listed debtors
+    sqlite3_finalize(rules);
+    rules = NULL;
+    const char *name_sql = "SELECT n.name, t.unit_type, COALESCE(f.number, r.number, '?') FROM tenancies t"
+                           " JOIN tenants n ON n.id = t.tenant_id"
+                           " LEFT JOIN flats f ON t.unit_type = 'flat' AND f.id = t.unit_id"
+                           " LEFT JOIN rooms r ON t.unit_type = 'room' AND r.id = t.unit_id"
+                           " WHERE t.id = ?;";
+    if (sqlite3_prepare_v2(db, name_sql, -1, &rules, NULL) != SQLITE_OK) {
+        goto cleanup;
+    }
+
+    printf("\nLargest arrears as of %s\n\n", as_of);
+    printf("%-8s %-22s %-5s %-10s %12s %10s %12s %6s\n",
+           "Tenancy", "Tenant", "Type", "Unit", "Outstanding", "Late fees", "Total owed", "Days");
+    printf("-------------------------------------------------------------------------------------------\n");
+    for (int i = 0; i < listed; i++) {
+        const char *name = "?", *type = "?", *unit = "?";
+
+        sqlite3_reset(rules);
+        sqlite3_bind_int(rules, 1, top[i].tenancy_id);
+        if (sqlite3_step(rules) == SQLITE_ROW) {
+            name = (const char*)sqlite3_column_text(rules, 0);
+            type = (const char*)sqlite3_column_text(rules, 1);
+            unit = (const char*)sqlite3_column_text(rules, 2);
+        }
+        printf("%-8d %-22.22s %-5s %-10.10s %12.2f %10.2f %12.2f %6d\n", top[i].tenancy_id, name, type, unit,
+               top[i].outstanding, top[i].fees, top[i].outstanding + top[i].fees, top[i].oldest_days);
+    }
+    if (listed == 0) {
+        printf("No arrears. Every invoice issued by %s is paid.\n", as_of);
+    } else if (debtors > listed) {
+        printf("... and %d more tenancies in arrears\n", debtors - listed);
+    }
+
+    double total_outstanding = 0;
+    printf("\nAging summary (unpaid rent by days past due)\n");
+    printf("-------------------------------\n");
+    for (int b = 0; b < ARREARS_BUCKETS; b++) {
+        printf("%-15s %15.2f\n", bucket_names[b], aging[b]);
+        total_outstanding += aging[b];
+    }
+    printf("-------------------------------\n");
+    printf("%-15s %15.2f\n", "Outstanding", total_outstanding);
+    printf("%-15s %15.2f\n", "Late fees", total_fees);
+    printf("%-15s %15.2f\n", "Total owed", total_outstanding + total_fees);
+    if (total_credit > 0.005) {
+        printf("%-15s %15.2f\n", "Unused credit", total_credit);
+    }
+    printf("\nTenancies in arrears: %d\n", debtors);
+    printf("Processed %lld invoices in %.3f s", invoice_count, seconds);
+    if (invoice_count > 0 && seconds > 0) {
+        printf(" (%.0f invoices/s)", invoice_count / seconds);
+    }
+    printf("\n");
+
+    sqlite3_finalize(rules);
+    sqlite3_finalize(invoices);
+    sqlite3_finalize(payments);
+    sqlite3_exec(db, "COMMIT;", 0, 0, 0);
+    return;
+
+cleanup:
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    sqlite3_finalize(rules);
+    sqlite3_finalize(invoices);
+    sqlite3_finalize(payments);
+    sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+}
+
+// Per-unit consumption for one month with flat and room subtotals. Only the
+// rollup rows for that period are read, through idx_utility_rollups_period.
+void utilityConsumptionReport(sqlite3 *db) {
+    clearScreen();
+    printf("\n=== UTILITY CONSUMPTION BY PERIOD ===\n\n");
+
+    char period[PERIOD_SIZE];
+    if (promptPeriod("Period (YYYY-MM, blank for current month): ", period) != 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    const char *sql = "SELECT u.unit_type, COALESCE(f.number, r.number, '?'),"
+                      " SUM(CASE WHEN u.utility = 'electricity' THEN u.consumption END),"
+                      " SUM(CASE WHEN u.utility = 'water' THEN u.consumption END)"
+                      " FROM utility_rollups u"
+                      " LEFT JOIN flats f ON u.unit_type = 'flat' AND f.id = u.unit_id"
+                      " LEFT JOIN rooms r ON u.unit_type = 'room' AND r.id = u.unit_id"
+                      " WHERE u.period = ? AND u.readings > 0"
+                      " GROUP BY u.unit_type, u.unit_id"
+                      " ORDER BY u.unit_type, 2;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, period, -1, SQLITE_STATIC);
+
+    printf("\n%-5s %-10s %14s %14s\n", "Type", "Unit", "Electricity", "Water");
+    printf("----------------------------------------------\n");
+
+    // Subtotals indexed by UNIT_FLAT / UNIT_ROOM, then electricity / water
+    double totals[2][2] = {{0, 0}, {0, 0}};
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *type = (const char*)sqlite3_column_text(stmt, 0);
+        int kind = strcmp(type, "room") == 0 ? UNIT_ROOM : UNIT_FLAT;
+        double electricity = sqlite3_column_double(stmt, 2);
+        double water = sqlite3_column_double(stmt, 3);
+
+        printf("%-5s %-10.10s %14.2f %14.2f\n", type,
+               (const char*)sqlite3_column_text(stmt, 1), electricity, water);
+        totals[kind][0] += electricity;
+        totals[kind][1] += water;
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+
+    if (count == 0) {
+        printf("No consumption recorded for %s.\n", period);
+        return;
+    }
+    printf("----------------------------------------------\n");
+    printf("%-16s %14.2f %14.2f\n", "Flats", totals[UNIT_FLAT][0], totals[UNIT_FLAT][1]);
+    printf("%-16s %14.2f %14.2f\n", "Rooms", totals[UNIT_ROOM][0], totals[UNIT_ROOM][1]);
+    printf("%-16s %14.2f %14.2f\n", "Total",
+           totals[UNIT_FLAT][0] + totals[UNIT_ROOM][0], totals[UNIT_FLAT][1] + totals[UNIT_ROOM][1]);
+}
+
+
+// Data Export Functions
+void dataExportMenu(sqlite3 *db) {
+    int choice;
+
+    while (1) {
+        clearScreen();
+        printf("\n==============================================\n");
+        printf("              DATA EXPORT (CSV)\n");
+        printf("==============================================\n");
+        printf("1. Export All Tables\n");
+        printf("2. Export Changes Since Last Export\n");
+        printf("0. Return to Main Menu\n");
+        printf("\nEnter your choice: ");
+
+        if (scanf("%d", &choice) != 1) {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number.\n");
+            waitForEnter();
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice) {
+            case 1:
+                exportAllTables(db);
+                break;
+            case 2:
+                exportChanges(db);
+                break;
+            case 0:
+                return;
+            default:
+                printf("Invalid choice. Please try again.\n");
+        }
+
+        waitForEnter();
+    }
+}
+
+static void csvFlush(CsvWriter *out) {
+    if (out->used > 0 && !out->failed) {
+        if (fwrite(out->data, 1, out->used, out->fp) != out->used) {
+            out->failed = 1;
+        }
+    }
+    out->bytes += out->used;
+    out->used = 0;
+}
+
+static void csvWrite(CsvWriter *out, const char *text, size_t len) {
+    if (out->used + len > EXPORT_BUFFER_SIZE) {
+        csvFlush(out);
+        if (len > EXPORT_BUFFER_SIZE) {
+            // Larger than the whole buffer: write it straight through
+            if (!out->failed && fwrite(text, 1, len, out->fp) != len) {
+                out->failed = 1;
+            }
+            out->bytes += len;
+            return;
+        }
+    }
+    memcpy(out->data + out->used, text, len);
+    out->used += len;
+}
+
+static void csvField(CsvWriter *out, const char *text, size_t len) {
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        char c = text[i];
+        if (c == ',' || c == '"' || c == '\r' || c == '\n') {
+            break;
+        }
+    }
+    if (i == len) {
+        csvWrite(out, text, len);
+        return;
+    }
+
+    // Quote the field, doubling each embedded quote
+    csvWrite(out, "\"", 1);
+    size_t start = 0;
+    for (i = 0; i < len; i++) {
+        if (text[i] == '"') {
+            csvWrite(out, text + start, i - start + 1);
+            csvWrite(out, "\"", 1);
+            start = i + 1;
+        }
+    }
+    csvWrite(out, text + start, len - start);
+    csvWrite(out, "\"", 1);
+}
+
+// Streams the rows of a prepared statement into path and finalizes it.
+// Returns the number of data rows written, or -1 on failure (in which case
+// path is left untouched).
+static long long exportQuery(sqlite3 *db, sqlite3_stmt *stmt, const char *path, char *buffer, long long *bytes) {
+    char tmp_path[EXPORT_PATH_SIZE + 8];
+    CsvWriter out = {NULL, buffer, 0, 0, 0};
+    long long rows = 0;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    out.fp = fopen(tmp_path, "wb");
+    if (out.fp == NULL) {
+        perror(tmp_path);
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+
+    int columns = sqlite3_column_count(stmt);
+    for (int i = 0; i < columns; i++) {
+        const char *name = sqlite3_column_name(stmt, i);
+        if (i > 0) csvWrite(&out, ",", 1);
+        csvField(&out, name, strlen(name));
+    }
+    csvWrite(&out, "\r\n", 2);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW && !out.failed) {
+        for (int i = 0; i < columns; i++) {
+            if (i > 0) csvWrite(&out, ",", 1);
+            if (sqlite3_column_type(stmt, i) != SQLITE_NULL) {
+                const char *text = (const char*)sqlite3_column_text(stmt, i);
+                csvField(&out, text, (size_t)sqlite3_column_bytes(stmt, i));
+            }
+        }
+        csvWrite(&out, "\r\n", 2);
+        rows++;
+    }
+    csvFlush(&out);
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+        fprintf(stderr, "Error fetching data: %s\n", sqlite3_errmsg(db));
+        out.failed = 1;
+    }
+    if (fclose(out.fp) != 0) {
+        out.failed = 1;
+    }
+    if (out.failed || rename(tmp_path, path) != 0) {
+        if (!out.failed) perror(path);
+        else fprintf(stderr, "Failed to write %s\n", tmp_path);
+        remove(tmp_path);
+        return -1;
+    }
+
+    *bytes = out.bytes;
+    return rows;
+}
+
+// Prepares the export query for one table: every row for a full export, or
+// only rows whose (updated_at, id) is past the table's watermark for an
+// incremental one, which is a range scan of idx_<table>_updated_at. The
+// tombstone log is keyed by its own sequence number. A table that has never
+// been exported has no watermark and is exported in full.
+static sqlite3_stmt *prepareExport(sqlite3 *db, const char *table, const char *columns, int incremental) {
+    char sql[1024];
+    sqlite3_stmt *stmt = NULL;
+    char watermark[32] = "";
+    long long last_id = 0;
+    int has_watermark = 0;
+
+    if (incremental) {
+        const char *lookup = "SELECT COALESCE(updated_at, ''), last_id FROM export_watermarks WHERE table_name = ?;";
+        if (sqlite3_prepare_v2(db, lookup, -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+            return NULL;
+        }
+        sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            snprintf(watermark, sizeof(watermark), "%s", (const char*)sqlite3_column_text(stmt, 0));
+            last_id = sqlite3_column_int64(stmt, 1);
+            has_watermark = 1;
+        }
+        sqlite3_finalize(stmt);
+        stmt = NULL;
+    }
+
+    if (strcmp(table, "deletions") == 0) {
+        snprintf(sql, sizeof(sql), "SELECT %s FROM export_tombstones WHERE seq > ?2 ORDER BY seq;", columns);
+    } else if (has_watermark) {
+        snprintf(sql, sizeof(sql), "SELECT %s, updated_at FROM %s"
+                 " WHERE (updated_at, id) > (?1, ?2) ORDER BY updated_at, id;", columns, table);
+    } else {
+        snprintf(sql, sizeof(sql), "SELECT %s, updated_at FROM %s ORDER BY id;", columns, table);
+    }
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return NULL;
+    }
+    if (sqlite3_bind_parameter_count(stmt) >= 2) {
+        sqlite3_bind_text(stmt, 1, watermark, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, last_id);
+    }
+    return stmt;
+}
+
+// Moves one table's watermark to the newest row in the export snapshot
+static int advanceWatermark(sqlite3 *db, const char *table) {
+    char sql[1024];
+
+    if (strcmp(table, "deletions") == 0) {
+        snprintf(sql, sizeof(sql), "INSERT OR REPLACE INTO export_watermarks (table_name, updated_at, last_id, exported_at)"
+                 " SELECT 'deletions', NULL, COALESCE(MAX(seq), 0), strftime('%%Y-%%m-%%d %%H:%%M:%%f', 'now')"
+                 " FROM export_tombstones;");
+    } else {
+        snprintf(sql, sizeof(sql), "INSERT OR REPLACE INTO export_watermarks (table_name, updated_at, last_id, exported_at)"
+                 " SELECT '%s', COALESCE(MAX(updated_at), ''), 0, strftime('%%Y-%%m-%%d %%H:%%M:%%f', 'now') FROM %s;"
+                 "UPDATE export_watermarks SET last_id = COALESCE((SELECT MAX(id) FROM %s"
+                 " WHERE updated_at = export_watermarks.updated_at), 0) WHERE table_name = '%s';",
+                 table, table, table, table);
+    }
+    if (sqlite3_exec(db, sql, 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    return 0;
+}
+
+// Export every table to <directory>, reporting throughput. A full export
+// writes <table>.csv with every row; an incremental one writes
+// <table>_<stamp>.csv with the rows changed since the last successful export
+// plus deletions_<stamp>.csv from the tombstone log. All files are read from
+// one snapshot, and the watermarks only advance if every file was written.
+static void runExport(sqlite3 *db, int incremental) {
+    static const struct {
+        const char *name;
+        const char *columns;
+    } tables[] = {
+        {"rooms", "id, number, description"},
+        {"flats", "id, number, description"},
+        {"tenants", "id, name, phone, email"},
+        {"tenancies", "id, tenant_id, unit_type, unit_id, start_date, end_date, monthly_rent,"
+                      " deposit, rent_review_date"},
+        {"invoices", "id, tenancy_id, period, issue_date, due_date, printf('%.2f', amount) AS amount"},
+        {"payments", "id, invoice_id, printf('%.2f', amount) AS amount, paid_on, method, reference"},
+        {"deletions", "seq, table_name, row_id, deleted_at"},
+    };
+    clearScreen();
+    printf(incremental ? "\n=== EXPORT CHANGES SINCE LAST EXPORT ===\n\n" : "\n=== EXPORT ALL TABLES ===\n\n");
+
+    char directory[EXPORT_PATH_SIZE - 64];
+    promptLine("Export directory (blank for current directory): ", directory, sizeof(directory));
+    if (directory[0] == '\0') {
+        strcpy(directory, ".");
+    }
+
+    // Delta files are named after the run; a second run within the same
+    // second gets a suffix rather than overwriting the earlier delta
+    char stamp[48];
+    time_t now = time(NULL);
+    strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%S", localtime(&now));
+    if (incremental) {
+        char base[32];
+        char probe[EXPORT_PATH_SIZE];
+        strcpy(base, stamp);
+        for (int n = 2; ; n++) {
+            snprintf(probe, sizeof(probe), "%s/%s_%s.csv", directory, tables[0].name, stamp);
+            FILE *existing = fopen(probe, "r");
+            if (existing == NULL) {
+                break;
+            }
+            fclose(existing);
+            snprintf(stamp, sizeof(stamp), "%s-%d", base, n);
+        }
+    }
+
+    char *buffer = malloc(EXPORT_BUFFER_SIZE);
+    if (buffer == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return;
+    }
+
+    printf("\n%-12s %10s %12s %9s %9s\n", "Table", "Rows", "Bytes", "Seconds", "MB/s");
+    printf("------------------------------------------------------\n");
+
+    long long total_bytes = 0;
+    int failed = 0;
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        free(buffer);
+        return;
+    }
+    for (size_t t = 0; t < sizeof(tables) / sizeof(tables[0]); t++) {
+        char path[EXPORT_PATH_SIZE];
+        long long bytes = 0;
+        struct timespec table_started;
+
+        // A full export has nothing to say about deletions
+        if (!incremental && strcmp(tables[t].name, "deletions") == 0) {
+            continue;
+        }
+        if (incremental) {
+            snprintf(path, sizeof(path), "%s/%s_%s.csv", directory, tables[t].name, stamp);
+        } else {
+            snprintf(path, sizeof(path), "%s/%s.csv", directory, tables[t].name);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &table_started);
+        sqlite3_stmt *stmt = prepareExport(db, tables[t].name, tables[t].columns, incremental);
+        long long rows = stmt ? exportQuery(db, stmt, path, buffer, &bytes) : -1;
+        double seconds = elapsedSeconds(&table_started);
+
+        if (rows < 0) {
+            printf("%-12s %10s\n", tables[t].name, "FAILED");
+            failed = 1;
+            continue;
+        }
+        printf("%-12s %10lld %12lld %9.3f %9.1f\n", tables[t].name, rows, bytes, seconds,
+               seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+        total_bytes += bytes;
+    }
+    free(buffer);
+
+    for (size_t t = 0; t < sizeof(tables) / sizeof(tables[0]) && !failed; t++) {
+        if (advanceWatermark(db, tables[t].name) != 0) {
+            failed = 1;
+        }
+    }
+    if (failed || sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK) {
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        printf("\nExport incomplete; watermarks were not advanced.\n");
+        return;
+    }
+
+    double seconds = elapsedSeconds(&started);
+    printf("------------------------------------------------------\n");
+    printf("%-12s %10s %12lld %9.3f %9.1f\n", "Total", "", total_bytes, seconds,
+           seconds > 0 ? total_bytes / seconds / 1e6 : 0.0);
+    printf("\nFiles written to %s\n", directory);
+}
+
+void exportAllTables(sqlite3 *db) {
+    runExport(db, 0);
+}
+
+void exportChanges(sqlite3 *db) {
+    runExport(db, 1);
 }